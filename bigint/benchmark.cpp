@@ -0,0 +1,767 @@
+// Замеры времени операций big_integer на случайных числах.
+//
+// Сборка: cmake -DBUILD_BENCHMARK=ON. Пороги алгоритмов из big_integer.cpp
+// можно переопределить, например
+// -DCMAKE_CXX_FLAGS="-DBIGINT_TOOM3_THRESHOLD=200", и сравнить вывод.
+//
+// Каждая функция ниже печатает одну таблицу, заметка перед ней -- итоги
+// её замеров и подбор порогов. Замеры сняты в Release, gcc 12, x86-64, на
+// одном ядре; у каждой таблицы указана ширина разряда, с которой она
+// снята: по умолчанию 64 бита, с -DBIGINT_LIMB_BITS=32 -- 32. Пороги в
+// разрядах подбирались с 32-битными разрядами и для 64-битных оставлены
+// прежними: выигрыш от перенастройки в пределах разброса замеров.
+
+#include "big_integer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+size_t allocations = 0;
+} // namespace
+
+void* operator new(size_t size) {
+  allocations++;
+  if (void* p = std::malloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+namespace {
+big_integer random_big_integer(std::mt19937& rng, size_t limbs) {
+  big_integer res;
+  for (size_t i = 0; i < limbs; i++) {
+    res <<= 32;
+    res += static_cast<uint32_t>(rng());
+  }
+  return res;
+}
+
+// Для длинных чисел: random_big_integer сдвигает всё число на каждом слове
+big_integer random_long_big_integer(std::mt19937& rng, size_t limbs) {
+  if (limbs <= 1024) {
+    return random_big_integer(rng, limbs);
+  }
+  size_t low = limbs / 2;
+  big_integer res = random_long_big_integer(rng, limbs - low);
+  res <<= 32 * low;
+  return res | random_long_big_integer(rng, low);
+}
+
+template <typename F>
+double measure(F f) {
+  using clock = std::chrono::steady_clock;
+  size_t reps = 0;
+  auto start = clock::now();
+  auto elapsed = clock::duration::zero();
+  do {
+    f();
+    reps++;
+    elapsed = clock::now() - start;
+  } while (elapsed < std::chrono::milliseconds(200));
+  return std::chrono::duration<double, std::micro>(elapsed).count() / reps;
+}
+
+// Среднее число выделений памяти за вызов f
+template <typename F>
+double count_allocations(F f) {
+  size_t before = allocations;
+  for (int i = 0; i < 1000; i++) {
+    f();
+  }
+  return (allocations - before) / 1000.0;
+}
+
+// Числа до 64 бит хранятся без выделения памяти, а арифметика над ними
+// идёт через __builtin_*_overflow. Первая строка вывода, нс на операцию,
+// 64-битные разряды:
+//
+//                             |  до   | после
+//   --------------------------+-------+-------
+//   c += 1                    |  73.9 |  14.5
+//   x = x * 3 + c; x %= p     | 608.9 |  80.4
+void bench_small_values() {
+  // Значения, помещающиеся в 64 бита: мкс на 1000 операций -- нс на одну
+  big_integer counter;
+  double inc = measure([&] {
+    for (int i = 0; i < 1000; i++) {
+      counter += 1;
+    }
+  });
+  big_integer x = 1;
+  double mulAddMod = measure([&] {
+    for (int i = 0; i < 1000; i++) {
+      x = x * 3 + counter;
+      x %= 1000000007;
+    }
+  });
+  std::printf("64-bit values: += 1 %.1f ns, * + %% %.1f ns\n", inc,
+              mulAddMod);
+}
+
+// Смешанные операции с встроенными целыми не создают временный
+// big_integer. Вторая строка вывода, выделений памяти на операцию
+// с 190-битным отрицательным a (копия a для результата неизбежна),
+// 64-битные разряды:
+//
+//            | a + 5 | a * 7 | a / 10 | a % 10 | a == 0 | a < 5
+//   ---------+-------+-------+--------+--------+--------+-------
+//    до      |     1 |     3 |     14 |     14 |      0 |     0
+//    после   |     1 |     2 |      1 |      1 |      0 |     0
+void bench_allocations() {
+  big_integer a("-1234567890123456789012345678901234567890123456789012345678");
+  big_integer c;
+  bool flag = false;
+  std::printf("allocations: a + 5 %.1f, a * 7 %.1f, a / 10 %.1f, "
+              "a %% 10 %.1f, a == 0 %.1f, a < 5 %.1f\n",
+              count_allocations([&] { c = a + 5; }),
+              count_allocations([&] { c = a * 7; }),
+              count_allocations([&] { c = a / 10; }),
+              count_allocations([&] { c = a % 10; }),
+              count_allocations([&] { flag ^= a == 0; }),
+              count_allocations([&] { flag ^= a < 5; }));
+}
+
+// Подбор порогов умножения, мкс на умножение n x n 32-битных разрядов:
+//
+//     n | столбик | Карацуба | Тоом-3 от 64 | Тоом-3 от 128 | Тоом-3 от 256
+//   ----+---------+----------+--------------+---------------+--------------
+//    16 |     0.7 |      0.8 |          0.7 |           0.6 |           0.8
+//    32 |     2.3 |      2.2 |          2.1 |           1.8 |           2.0
+//    64 |     5.4 |      6.3 |          5.4 |           4.4 |           5.6
+//   128 |    18.8 |     18.4 |         13.5 |          12.5 |          18.5
+//   256 |    86.4 |     55.2 |         43.8 |          38.4 |          52.4
+//   512 |   349.4 |    166.7 |        122.3 |         116.3 |         149.1
+//  1024 |  1502.7 |    408.2 |        378.4 |         377.1 |         431.6
+//  2048 |  6377.0 |   1321.3 |        878.7 |        1124.5 |        1200.8
+//  4096 | 22683.2 |   3881.7 |       2297.6 |        2571.8 |        3020.4
+//  8192 | 88466.9 |  11482.5 |       7703.7 |        7731.7 |        8735.3
+//
+// Разброс между запусками около 20%, поэтому пороги 64 и 128 для Тоом-3
+// практически неразличимы; выбран 128.
+//
+// Порог преобразования Фурье по простым модулям, мкс, 32-битные разряды
+// (без него -- Тоом-3):
+//
+//       n | Тоом-3 | NTT
+//   ------+--------+-------
+//     512 |  135.7 |  170.0
+//    1024 |  406.9 |  409.1
+//    1536 |  839.9 |  870.3
+//    2048 | 1189.3 | 1038.8
+//    3000 | 1705.7 | 2017.5
+//    4096 | 2986.9 | 2194.8
+//   16384 |  22389 |   7821
+//   65536 | 130075 |  41727
+//
+// Длина преобразования -- степень двойки, поэтому время NTT растёт
+// ступеньками; выигрыш устойчив начиная с 2048 разрядов.
+//
+// Возведение в квадрат (столбец sqr) на всех уровнях быстрее умножения
+// в 1.3-1.7 раза, 32-битные разряды: 13.5 против 18.0 мкс на 128
+// разрядах, 647.7 против 953.4 на 2048, 27411 против 45298 на 65536.
+//
+// 64-битные разряды против 32-битных, мкс, по выводу этой и двух
+// следующих таблиц:
+//
+//           |    сложение   |   умножение   |     деление     |    to_string
+//       бит |    64 |    32 |    64 |    32 |     64 |     32 |     64 |     32
+//   --------+-------+-------+-------+-------+--------+--------+--------+-------
+//      1024 |  0.32 |  0.29 |   1.0 |   1.7 |    7.9 |   18.5 |    4.3 |    5.5
+//      4096 |  0.66 |  0.60 |   7.8 |  11.6 |   59.8 |  116.8 |   28.3 |   84.5
+//     16384 |  2.56 |  3.07 |  59.8 | 133.8 |  348.0 |  903.4 |  532.8 | 1195.0
+//     65536 |  6.53 | 10.52 |   432 |   974 |   2699 |   4974 |   4403 |   9561
+//    262144 | 23.75 | 32.05 |  3695 |  3663 |  15429 |  35666 |  31785 |  61222
+//   1048576 | 99.77 | 122.0 | 18687 | 16150 | 110954 | 122604 | 209588 | 301080
+//
+// Умножение и деление до ~10^5 бит ускоряются в 1.5-2.5 раза: произведение
+// 64 x 64 бит стоит почти столько же, сколько 32 x 32, а разрядов вдвое
+// меньше. На больших длинах время определяет NTT, которое и так работает
+// с 64-битными цифрами, поэтому разница пропадает. Сложение упирается
+// в память и выигрывает меньше.
+void bench_multiplication(std::mt19937& rng) {
+  std::printf("\n%8s %12s %12s %12s\n", "bits", "add, us", "mul, us",
+              "sqr, us");
+  // Длины в 32-битных словах, чтобы сравнивать сборки с разным limb
+  for (size_t n : {16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192,
+                   16384, 32768, 65536}) {
+    big_integer a = random_big_integer(rng, n);
+    big_integer b = random_big_integer(rng, n);
+    big_integer c;
+    double add = measure([&] { c = a + b; });
+    double mul = measure([&] { c = a * b; });
+    double sqr = measure([&] { c = a * a; });
+    std::printf("%8zu %12.2f %12.1f %12.1f\n", 32 * n, add, mul, sqr);
+  }
+}
+
+// Деление 2n разрядов на n, мкс, 32-битные разряды (лучшее из нескольких
+// запусков): в столбик, Бурникель-Циглер с делением в столбик от 32
+// разрядов, через обратное
+//
+//        n | в столбик | Бурникель-Циглер |  Ньютон
+//   -------+-----------+------------------+---------
+//       32 |      24.6 |             23.3 |    20.4
+//      128 |     370.3 |            139.5 |   115.1
+//      256 |    1004.4 |            229.4 |   320.0
+//     1024 |   23937.7 |           2300.7 |  2551.0
+//     4096 |  434613.5 |          14000.4 | 18454.4
+//    16384 |           |            60787 |   89496
+//    65536 |           |           337000 |  306000
+//   262144 |           |          1859300 | 1503300
+//
+// Деление через обратное стоит пяти-шести умножений n x n и обгоняет
+// рекурсивное деление, у которого добавляется логарифм, только на
+// сотнях тысяч разрядов.
+//
+// Деление в столбик по алгоритму D Кнута на сырых разрядах: цифра частного
+// оценивается делением трёх старших разрядов на два умножением на обратное,
+// вычитание q * b совмещено с умножением, исправление не больше одного.
+// Деление 2n разрядов на n, мкс, 64-битные разряды:
+//
+//        n |    2 |    8 |   16 |    32 |    64 |   128 |   256 |    512
+//   -------+------+------+------+-------+-------+-------+-------+-------
+//    до    | 0.51 | 2.63 | 6.88 | 19.18 | 67.02 | 233.9 | 882.2 | 3708.7
+//    после | 0.21 | 0.33 | 0.77 |  2.19 |  8.68 |  36.6 | 115.3 |  369.6
+//
+// Бурникель-Циглер с порогом в разрядах, мкс, 64-битные разряды:
+//
+//        n |  столбик |    64 |   128 |   256
+//   -------+----------+-------+-------+-------
+//       64 |     10.7 |  20.4 |  10.5 |   9.8
+//      128 |     36.0 |  67.2 |  51.1 |  39.3
+//      256 |    144.4 | 200.8 | 172.9 | 158.2
+//      512 |    569.3 | 480.1 | 470.3 | 502.7
+//     1024 |     2178 |  1548 |  1600 |  1588
+//     4096 |    37879 | 14859 | 13031 | 13613
+//
+// Выбран порог 256: до него столбик не медленнее, дальше разница в
+// пределах разброса.
+void bench_division(std::mt19937& rng) {
+  std::printf("\n%8s %12s\n", "bits", "div, us");
+  // Длины в 32-битных словах, чтобы сравнивать сборки с разным limb
+  for (size_t n : {16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192,
+                   16384, 32768, 65536}) {
+    big_integer a = random_big_integer(rng, n);
+    big_integer b = random_big_integer(rng, n);
+    big_integer c;
+    // Частное 2n слов на n слов
+    big_integer ab = a * b + a;
+    double div = measure([&] { c = ab / b; });
+    std::printf("%8zu %12.1f\n", 32 * n, div);
+  }
+}
+
+// Перевод в десятичную строку, мкс, 32-битные разряды, в зависимости от
+// порога, ниже которого остаток переводится делением на 10^9 (без порога
+// -- только деление на 10^9):
+//
+//       n |      16 |      32 |      64 |     128 | без порога
+//   ------+---------+---------+---------+---------+-----------
+//      64 |    61.8 |    34.0 |    29.1 |    16.9 |       14.0
+//     256 |   404.3 |   392.8 |   347.0 |   268.6 |      186.1
+//    1024 |    4390 |    3071 |    3260 |    2834 |       2828
+//    4096 |   30754 |   19850 |   24239 |   20369 |      41132
+//   16384 |  186938 |  149505 |  205540 |  142718 |     662348
+//   65536 | 1075101 |  948829 | 1107831 |  873099 |   10503837
+//
+// Выбран порог 128.
+//
+// Разбор десятичной строки, мкс, 32-битные разряды, в зависимости от
+// порога в разрядах, ниже которого число набирается умножением на 10^9
+// (до -- только умножение):
+//
+//    цифр |      16 |      32 |      64 |     128 |  умножение
+//   ------+---------+---------+---------+---------+-----------
+//    1000 |    14.0 |    12.6 |     8.1 |     7.0 |       21.7
+//   10000 |   716.4 |   691.3 |   373.1 |   607.0 |     2176.5
+//   10^5  |   19646 |   18067 |   12722 |   16061 |     144134
+//   10^6  |  301939 |  234504 |  231190 |  268889 |   16505773
+//
+// Выбран порог 64.
+void bench_decimal(std::mt19937& rng) {
+  std::printf("\n%8s %14s %12s\n", "bits", "to_string, us", "parse, us");
+  // Длины в 32-битных словах, чтобы сравнивать сборки с разным limb
+  for (size_t n : {16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192,
+                   16384, 32768, 65536}) {
+    big_integer a = random_big_integer(rng, n);
+    big_integer c;
+    std::string s;
+    double str = measure([&] { s = to_string(a); });
+    double parse = measure([&] { c = big_integer(s); });
+    std::printf("%8zu %14.1f %12.1f\n", 32 * n, str, parse);
+  }
+}
+
+// powmod по нечётному модулю умножает по Монтгомери: прибавление a * b[i]
+// и редукция идут одним проходом по разрядам, скользящее окно до 6 бит.
+// Таблица вывода, мс, 64-битные разряды:
+//
+//    бит | * и % | powmod | чётный модуль
+//   -----+-------+--------+---------------
+//    512 |  0.38 |   0.10 |          0.33
+//   1024 |  1.66 |   0.60 |          1.35
+//   2048 | 14.40 |   4.52 |         13.59
+//   4096 | 88.18 |  37.02 |         61.90
+//   8192 | 407.4 |  271.8 |         401.5
+//
+// Отдельные проходы умножения и редукции были вдвое медленнее. Редукция
+// тремя быстрыми умножениями до 8192 бит не выигрывает у однопроходной.
+void bench_powmod(std::mt19937& rng) {
+  std::printf("\n%8s %16s %16s %16s\n", "bits", "* and %, ms",
+              "powmod odd, ms", "powmod even, ms");
+  for (size_t n : {16, 32, 64, 128, 256}) {
+    big_integer m = random_big_integer(rng, n) | 1;
+    big_integer x = random_big_integer(rng, n) % m;
+    big_integer e = random_big_integer(rng, n);
+    big_integer c;
+    // Возведение в степень, как его пишут вручную
+    double naive = measure([&] {
+      c = 1;
+      big_integer y = x;
+      for (big_integer k = e; k != 0; k >>= 1) {
+        if ((k & 1) != 0) {
+          c = c * y % m;
+        }
+        y = y * y % m;
+      }
+    });
+    double odd = measure([&] { c = powmod(x, e, m); });
+    double even = measure([&] { c = powmod(x, e, m + 1); });
+    std::printf("%8zu %16.2f %16.2f %16.2f\n", 32 * n, naive / 1000,
+                odd / 1000, even / 1000);
+  }
+}
+
+// modulus_context приводит произведение двух вычетов по Барретту: старшая
+// половина произведения на обратное и младшие n + 1 разрядов произведения
+// частного на модуль, рабочий буфер живёт в контексте. Короче 128
+// разрядов нужные столбцы считаются в столбик, дальше -- произведения
+// целиком. Таблица вывода, мкс, 64-битные разряды:
+//
+//      бит |  a * b |  ab % m | reduce(ab)
+//   -------+--------+---------+-----------
+//      512 |   0.19 |    0.41 |       0.35
+//     2048 |   1.54 |    2.30 |       2.00
+//     8192 |  14.60 |   39.32 |      37.20
+//    32768 |  151.8 |   369.0 |      234.4
+//   131072 |   1697 |    3466 |       3489
+//   524288 |   7649 |   26868 |      15673
+//
+// До 8192 бит деление в столбик стоит около n^2, как и два неполных
+// произведения, поэтому выигрыш невелик. На 131072 битах оба произведения
+// уже идут через NTT, а деление умножает половины Тоомом-3; от
+// NTT_THRESHOLD до 2 * NTT_THRESHOLD разрядов reduce поэтому просто
+// делит. Без буфера в контексте и с полными произведениями reduce был
+// медленнее % на всех длинах до 131072 бит.
+void bench_barrett(std::mt19937& rng) {
+  std::printf("\n%8s %12s %12s %14s\n", "bits", "mul, us", "%, us",
+              "barrett, us");
+  for (size_t n : {16, 64, 256, 1024, 4096, 16384}) {
+    big_integer m = random_big_integer(rng, n);
+    big_integer a = random_big_integer(rng, n) % m;
+    big_integer b = random_big_integer(rng, n) % m;
+    big_integer ab = a * b;
+    modulus_context ctx(m);
+    big_integer c;
+    double mul = measure([&] { c = a * b; });
+    double rem = measure([&] { c = ab % m; });
+    double barrett = measure([&] { c = ctx.reduce(ab); });
+    std::printf("%8zu %12.2f %12.2f %14.2f\n", 32 * n, mul, rem, barrett);
+  }
+}
+
+// gcd -- шаги Лемера по старшим 2 * BASE - 2 битам: около BASE бит за
+// проход по разрядам вместо одного деления на шаг Евклида; от 2048
+// 64-битных разрядов (1024 для gcd_ext) -- половинный НОД. Таблица
+// вывода, мс, 64-битные разряды:
+//
+//      бит | Евклид % |    gcd | gcd_ext | modinv
+//   -------+----------+--------+---------+--------
+//      512 |    0.076 |  0.010 |   0.017 |  0.017
+//     2048 |    0.489 |  0.045 |   0.065 |  0.066
+//     8192 |    4.414 |  0.277 |   0.490 |  0.433
+//    32768 |    311.5 |  1.909 |   3.769 |  3.372
+//   131072 |        - |  17.05 |   29.99 |  30.35
+//   262144 |        - |  47.59 |   80.47 |  85.40
+//
+// Половинный НОД обгоняет шаги Лемера только с нескольких тысяч
+// разрядов: перенос матриц на младшие разряды стоит несколько умножений
+// на уровень рекурсии.
+void bench_gcd(std::mt19937& rng) {
+  std::printf("\n%8s %14s %12s %14s %12s\n", "bits", "euclid %, ms",
+              "gcd, ms", "gcd_ext, ms", "modinv, ms");
+  for (size_t n : {16, 64, 256, 1024, 4096, 8192}) {
+    big_integer a = random_big_integer(rng, n);
+    big_integer b = random_big_integer(rng, n) | 1;
+    big_integer c, x, y;
+    // Алгоритм Евклида, как его пишут вручную; на длинных числах слишком
+    // долог
+    double naive = 0;
+    if (n <= 1024) {
+      naive = measure([&] {
+        big_integer u = a, v = b;
+        while (v != 0) {
+          u %= v;
+          std::swap(u, v);
+        }
+        c = u;
+      });
+    }
+    double g = measure([&] { c = gcd(a, b); });
+    double ext = measure([&] { c = gcd_ext(a, b, x, y); });
+    while (gcd(a, b) != 1) {
+      a += 1;
+    }
+    double inv = measure([&] { c = modinv(a, b); });
+    char euclid[32] = "-";
+    if (naive != 0) {
+      std::snprintf(euclid, sizeof(euclid), "%.3f", naive / 1000);
+    }
+    std::printf("%8zu %14s %12.3f %14.3f %12.3f\n", 32 * n, euclid,
+                g / 1000, ext / 1000, inv / 1000);
+  }
+}
+
+// isqrt и iroot -- один шаг Ньютона на уровень от корня из старшей
+// половины бит, поэтому итоговая цена -- около двух делений 2n на n
+// разрядов. Таблица вывода, мкс, 64-битные разряды:
+//
+//       бит | деление |  isqrt | iroot 3
+//   --------+---------+--------+---------
+//      1024 |    0.39 |   3.61 |    4.63
+//      4096 |    2.07 |   9.48 |   12.69
+//     16384 |   33.97 |  87.57 |  123.80
+//     65536 |   509.5 |  879.3 |  1038.8
+//    262144 |    2948 |   7237 |    7969
+//   1048576 |   32596 |  33719 |   57893
+void bench_roots(std::mt19937& rng) {
+  std::printf("\n%8s %12s %12s %14s\n", "bits", "div, us", "isqrt, us",
+              "iroot 3, us");
+  for (size_t n : {16, 64, 256, 1024, 4096, 16384}) {
+    big_integer a = random_big_integer(rng, 2 * n);
+    big_integer b = random_big_integer(rng, n);
+    big_integer c;
+    // Частное 2n слов на n слов, как внутри шага Ньютона для корня
+    double div = measure([&] { c = a / b; });
+    double sqrt = measure([&] { c = isqrt(a); });
+    double cbrt = measure([&] { c = iroot(a, 3); });
+    std::printf("%8zu %12.2f %12.2f %14.2f\n", 64 * n, div, sqrt, cbrt);
+  }
+}
+
+// Основания-степени двойки переводятся в строку и обратно по битам за один
+// проход по разрядам, модуль отрицательного числа считается по ходу;
+// остальные основания -- делением пополам на степени, как десятичное.
+// Таблица вывода, мкс, 64-битные разряды:
+//
+//       бит | основание 10 |     16 | разбор 16 |     36 | разбор 36
+//   --------+--------------+--------+-----------+--------+-----------
+//       512 |         2.20 |   0.46 |      0.48 |   2.15 |      0.51
+//      8192 |        88.56 |   5.87 |      3.83 |  97.66 |     18.19
+//    131072 |       5981.2 |  92.22 |     65.24 | 5391.6 |    2334.9
+//   2097152 |       305804 |   1471 |      1337 | 326667 |    105749
+//
+// Символы цифр разбираются по таблице: сравнения с диапазонами '0'-'9' и
+// 'a'-'z' на случайных цифрах давали в 5-8 раз более медленный разбор.
+void bench_bases(std::mt19937& rng) {
+  std::printf("\n%8s %12s %12s %12s %12s %12s\n", "bits", "dec, us",
+              "hex, us", "parse hex", "base 36, us", "parse 36");
+  for (size_t n : {16, 256, 4096, 65536}) {
+    big_integer a = -random_big_integer(rng, n);
+    big_integer c;
+    std::string s;
+    double dec = measure([&] { s = to_string(a); });
+    double hex = measure([&] { s = to_string(a, 16); });
+    double parseHex = measure([&] { c = big_integer(s, 16); });
+    double b36 = measure([&] { s = to_string(a, 36); });
+    double parse36 = measure([&] { c = big_integer(s, 36); });
+    std::printf("%8zu %12.2f %12.2f %12.2f %12.2f %12.2f\n", 32 * n, dec,
+                hex, parseHex, b36, parse36);
+  }
+}
+
+// Двоичная запись -- длина, знак и байты разрядов, скопированные memcpy;
+// decode пишет в буфер числа, не выделяя память, если его хватает.
+// Таблица вывода, мкс, 64-битные разряды:
+//
+//       бит | to_string |  разбор | encode | decode
+//   --------+-----------+---------+--------+--------
+//       512 |      1.47 |    0.33 |  0.042 |  0.053
+//      8192 |     92.09 |   24.92 |  0.074 |  0.068
+//    131072 |    4090.5 |  1402.2 |  0.243 |  0.243
+//   2097152 |    393866 |  138215 |  9.600 | 11.006
+void bench_binary(std::mt19937& rng) {
+  std::printf("\n%8s %14s %12s %12s %12s\n", "bits", "to_string, us",
+              "parse, us", "encode, us", "decode, us");
+  for (size_t n : {16, 256, 4096, 65536}) {
+    big_integer a = -random_big_integer(rng, n);
+    big_integer c;
+    std::string s;
+    double str = measure([&] { s = to_string(a); });
+    double parse = measure([&] { c = big_integer(s); });
+    std::string bytes(a.encoded_size(), '\0');
+    unsigned char* out = reinterpret_cast<unsigned char*>(&bytes[0]);
+    double enc = measure([&] { a.encode(out); });
+    double dec = measure([&] { c.decode(out, bytes.size()); });
+    std::printf("%8zu %14.2f %12.2f %12.3f %12.3f\n", 32 * n, str, parse,
+                enc, dec);
+  }
+}
+
+// std::hash<big_integer> перемешивает разряды по 64 бита, как MurmurHash3,
+// hashed_big_integer хранит хеш вместе с ключом, и при поиске остаётся
+// только сравнение значений. Таблица вывода, мкс на поиск среди 100
+// ключей, 64-битные разряды:
+//
+//      бит | ключ to_string |  hash | посчитанный хеш
+//   -------+----------------+-------+-----------------
+//       64 |          0.466 | 0.024 |           0.018
+//      512 |          1.658 | 0.064 |           0.030
+//     8192 |          84.67 | 0.529 |           0.235
+//   131072 |         5347.7 | 7.897 |           3.153
+void bench_hash(std::mt19937& rng) {
+  std::printf("\n%8s %16s %12s %14s\n", "bits", "to_string key, us",
+              "hash, us", "precomputed, us");
+  for (size_t n : {2, 16, 256, 4096}) {
+    std::unordered_map<std::string, int> byString;
+    std::unordered_map<big_integer, int> byValue;
+    std::unordered_map<hashed_big_integer, int> byHashed;
+    std::vector<big_integer> keys;
+    for (int i = 0; i < 100; i++) {
+      keys.push_back(random_big_integer(rng, n));
+      byString[to_string(keys.back())] = i;
+      byValue[keys.back()] = i;
+      byHashed[hashed_big_integer(keys.back())] = i;
+    }
+    std::vector<hashed_big_integer> hashedKeys;
+    for (big_integer const& k : keys) {
+      hashedKeys.emplace_back(k);
+    }
+    int sum = 0;
+    // Время на один поиск
+    double str = measure([&] {
+      for (big_integer const& k : keys) {
+        sum += byString.at(to_string(k));
+      }
+    });
+    double value = measure([&] {
+      for (big_integer const& k : keys) {
+        sum += byValue.at(k);
+      }
+    });
+    double hashed = measure([&] {
+      for (hashed_big_integer const& k : hashedKeys) {
+        sum += byHashed.at(k);
+      }
+    });
+    std::printf("%8zu %16.3f %12.3f %14.3f\n", 32 * n, str / 100,
+                value / 100, hashed / 100);
+  }
+}
+
+// to_chars пишет цифры прямо в буфер вызывающего, если в нём помещается
+// оценка to_chars_size, иначе через временный; from_chars и operator>>
+// не собирают строку. Поток читается кусками по 64 разряда цифр, куски
+// объединяются, как двоичный счётчик, поэтому разбор из потока остаётся
+// разделяй-и-властвуй. Таблица вывода, мкс, 64-битные разряды (в operator>>
+// входит копирование строки в поток):
+//
+//      бит | to_string | to_chars | разбор | from_chars | поток >>
+//   -------+-----------+----------+--------+------------+----------
+//      128 |      0.68 |     0.51 |   0.27 |       0.28 |     0.68
+//     2048 |      8.94 |     8.58 |   1.83 |       2.43 |     6.00
+//    32768 |     684.2 |    820.5 |  296.7 |      287.2 |    272.3
+//   524288 |     52239 |    53939 |  15702 |      19826 |    18417
+void bench_chars(std::mt19937& rng) {
+  std::printf("\n%8s %14s %12s %12s %14s %12s\n", "bits", "to_string, us",
+              "to_chars", "parse, us", "from_chars", "stream >>");
+  for (size_t n : {4, 64, 1024, 16384}) {
+    big_integer a = -random_big_integer(rng, n);
+    big_integer c;
+    std::string s;
+    std::string buf(to_chars_size(a), '\0');
+    char* out = &buf[0];
+    double str = measure([&] { s = to_string(a); });
+    double chars = measure([&] { to_chars(out, out + buf.size(), a); });
+    double parse = measure([&] { c = big_integer(s); });
+    double from = measure(
+        [&] { from_chars(s.data(), s.data() + s.size(), c); });
+    std::istringstream in;
+    double stream = measure([&] {
+      in.clear();
+      in.str(s);
+      in >> c;
+    });
+    std::printf("%8zu %14.2f %12.2f %12.2f %14.2f %12.2f\n", 32 * n, str,
+                chars, parse, from, stream);
+  }
+}
+
+// С set_multiplication_threads(N) умножение от BIGINT_PARALLEL_THRESHOLD
+// разрядов делит между потоками загрузку, широкие слои преобразований,
+// поточечное произведение и разбор свёртки; узкие слои идут блоками по
+// потоку на блок, переносы -- последовательно. Задания раздаются общим
+// счётчиком, вызывающий поток работает наравне с пулом. Ускорение не
+// измерено: машина, где снимались эти таблицы, одноядерная, и там второй
+// поток только добавлял 1-20% накладных расходов. Поэтому по умолчанию
+// умножение последовательное, а на одном ядре benchmark таблицу
+// пропускает.
+void bench_threads(std::mt19937& rng) {
+  // Умножение ниже порога BIGINT_PARALLEL_THRESHOLD всегда последовательное
+  size_t cores = std::thread::hardware_concurrency();
+  if (cores < 2) {
+    std::printf("\nthreads: skipped, one core\n");
+  } else {
+    std::printf("\n%8s %12s %12s %12s %12s (threads: %zu)\n", "bits",
+                "mul 1, ms", "mul N, ms", "sqr 1, ms", "sqr N, ms", cores);
+    for (size_t n : {16384, 65536, 262144}) {
+      big_integer a = random_long_big_integer(rng, n);
+      big_integer b = random_long_big_integer(rng, n);
+      big_integer c;
+      double serial = measure([&] { c = a * b; });
+      double sqrSerial = measure([&] { c = a * a; });
+      set_multiplication_threads(cores);
+      double parallel = measure([&] { c = a * b; });
+      double sqrParallel = measure([&] { c = a * a; });
+      set_multiplication_threads(1);
+      std::printf("%8zu %12.2f %12.2f %12.2f %12.2f\n", 32 * n,
+                  serial / 1000, parallel / 1000, sqrSerial / 1000,
+                  sqrParallel / 1000);
+    }
+  }
+}
+
+// big_integer_batch хранит числа одной ширины по столбцам разрядов, и
+// операция над набором -- несколько циклов по столбцу без выделений
+// памяти. Умножение по столбцам квадратично, поэтому с 12 разрядов
+// (48 для 32-битных) набор умножается по одному числу, как operator*, но
+// без выделений памяти. Таблица вывода, нс на число в наборе из 4096
+// (сумма на разряд шире, произведение вдвое), 64-битные разряды:
+//
+//      бит |     + | набор + |     * | набор * |    < | compare
+//   -------+-------+---------+-------+---------+------+---------
+//      128 | 39.30 |    8.43 | 160.7 |   26.82 | 2.76 |    3.85
+//      256 | 46.39 |    9.07 | 172.0 |   58.49 | 4.06 |    3.88
+//     1024 | 95.82 |   32.69 | 848.3 |   691.7 | 4.47 |    5.08
+//
+// По столбцам на 1024 битах выходило 949.5 нс против 856.4 у operator*:
+// 64-битные произведения разрядов не векторизуются, и умножение набора
+// упирается в накопители в памяти. С 32-битными разрядами цикл по числам
+// векторизуется и выигрывает до 1536 бит.
+void bench_batch(std::mt19937& rng) {
+  std::printf("\n%8s %12s %12s %12s %12s %12s %12s\n", "bits", "+, ns",
+              "batch +, ns", "*, ns", "batch *, ns", "<, ns", "compare");
+  for (size_t n : {4, 8, 32}) {
+    // Результат на разряд шире, произведение -- вдвое
+    size_t lanes = 4096;
+    size_t width = 32 * n / (8 * sizeof(big_integer::limb));
+    big_integer_batch a(lanes, width), b(lanes, width);
+    big_integer_batch sum(lanes, width + 1), prod(lanes, 2 * width);
+    std::vector<big_integer> x, y, z(lanes);
+    std::vector<int32_t> cmp(lanes);
+    for (size_t i = 0; i < lanes; i++) {
+      x.push_back(random_big_integer(rng, n - 1));
+      y.push_back(-random_big_integer(rng, n - 1));
+      a.set(i, x[i]);
+      b.set(i, y[i]);
+    }
+    int less = 0;
+    double add1 = measure([&] {
+      for (size_t i = 0; i < lanes; i++) {
+        z[i] = x[i] + y[i];
+      }
+    });
+    double addN = measure([&] { add(sum, a, b); });
+    double mul1 = measure([&] {
+      for (size_t i = 0; i < lanes; i++) {
+        z[i] = x[i] * y[i];
+      }
+    });
+    double mulN = measure([&] { mul(prod, a, b); });
+    double cmp1 = measure([&] {
+      for (size_t i = 0; i < lanes; i++) {
+        less += x[i] < y[i];
+      }
+    });
+    double cmpN = measure([&] { compare(a, b, cmp.data()); });
+    double ns = 1000.0 / lanes;
+    std::printf("%8zu %12.2f %12.2f %12.2f %12.2f %12.2f %12.2f\n", 32 * n,
+                add1 * ns, addN * ns, mul1 * ns, mulN * ns, cmp1 * ns,
+                cmpN * ns);
+  }
+}
+
+// &, |, ^, ~ и and_not над общими разрядами идут векторами AVX2 или SSE2
+// по CPUID, разряды за коротким операндом -- его знак, поэтому они
+// остаются, заполняются или инвертируются целиком. Таблица вывода, мкс,
+// 64-битные разряды (в ~ и a & b входит копирование числа):
+//
+//       бит |       |    &= |    |= |    ^= |     ~ | a & b
+//   --------+-------+-------+-------+-------+-------+-------
+//      8192 | до    | 0.188 | 0.210 | 0.197 | 0.193 | 0.344
+//           | после | 0.054 | 0.068 | 0.053 | 0.083 | 0.086
+//    131072 | до    | 3.645 | 3.144 | 3.967 | 1.331 | 4.126
+//           | после | 0.252 | 0.256 | 0.300 | 0.526 | 1.064
+//   1048576 | до    | 19.14 | 20.63 | 26.73 | 13.16 | 59.10
+//           | после | 4.218 | 4.113 | 4.508 | 7.250 | 8.224
+//
+// На 1048576 битах операнды уже не помещаются в кеш второго уровня, и
+// &= упирается в пропускную способность памяти.
+void bench_bitwise(std::mt19937& rng) {
+  std::printf("\n%8s %12s %12s %12s %12s %12s\n", "bits", "&=, us",
+              "|=, us", "^=, us", "~, us", "a & b, us");
+  for (size_t n : {256, 4096, 32768}) {
+    big_integer a = random_long_big_integer(rng, n);
+    big_integer b = -random_long_big_integer(rng, n);
+    big_integer c = a;
+    // ^= первым: после &= и |= число совпало бы с b и обнулялось
+    double exc = measure([&] { c ^= b; });
+    double conj = measure([&] { c &= b; });
+    double disj = measure([&] { c |= b; });
+    double inv = measure([&] { c = ~a; });
+    double copy = measure([&] { c = a & b; });
+    std::printf("%8zu %12.3f %12.3f %12.3f %12.3f %12.3f\n", 32 * n, conj,
+                disj, exc, inv, copy);
+  }
+}
+} // namespace
+
+int main() {
+  bench_small_values();
+  bench_allocations();
+  std::mt19937 rng(2023);
+  bench_multiplication(rng);
+  bench_division(rng);
+  bench_decimal(rng);
+  bench_powmod(rng);
+  bench_barrett(rng);
+  bench_gcd(rng);
+  bench_roots(rng);
+  bench_bases(rng);
+  bench_binary(rng);
+  bench_hash(rng);
+  bench_chars(rng);
+  bench_threads(rng);
+  bench_batch(rng);
+  bench_bitwise(rng);
+}
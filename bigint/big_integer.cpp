@@ -1,12 +1,114 @@
 #include "big_integer.h"
 #include <algorithm>
+#include <cmath>
+#include <condition_variable>
 #include <cstddef>
 #include <cstring>
+#include <deque>
+#include <functional>
+#include <istream>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <ostream>
 #include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
-static const uint32_t BASE = 32;
+// Поразрядные операции над длинными массивами разрядов векторными
+// командами x86: SSE2 всегда есть на x86-64, AVX2 выбирается по CPUID при
+// первом вызове. -DBIGINT_SIMD=0 оставляет только обычные циклы
+#ifndef BIGINT_SIMD
+#if defined(__x86_64__) || defined(__i386__)
+#define BIGINT_SIMD 1
+#else
+#define BIGINT_SIMD 0
+#endif
+#endif
+#if BIGINT_SIMD
+#include <immintrin.h>
+#define BIGINT_TARGET_SSE2 __attribute__((target("sse2")))
+#define BIGINT_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+// Разряд и удвоенный разряд для промежуточных произведений и переносов
+typedef big_integer::limb limb;
+#if BIGINT_LIMB_BITS == 64
+__extension__ typedef unsigned __int128 dlimb;
+#else
+typedef uint64_t dlimb;
+#endif
+// Знаковые разряд и удвоенный разряд для коэффициентов шагов Лемера
+typedef std::make_signed<limb>::type slimb;
+#if BIGINT_LIMB_BITS == 64
+__extension__ typedef __int128 sdlimb;
+#else
+typedef int64_t sdlimb;
+#endif
+
+static const uint32_t BASE = BIGINT_LIMB_BITS;
+
+// Длина и знак перед байтами двоичной записи
+static const size_t ENCODED_HEADER = 9;
+// Разряды лежат в памяти в порядке байтов двоичной записи
+static const bool LITTLE_ENDIAN_LIMBS =
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+// Цифры систем счисления с основанием до 36
+static constexpr char DIGIT_CHARS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+// Значения цифр по символу: таблица вместо сравнений, потому что на
+// случайных цифрах ветвления по диапазонам символов плохо предсказываются
+struct digit_values {
+  uint8_t value[256];
+};
+
+static constexpr digit_values makeDigitValues() {
+  digit_values res = {};
+  for (size_t c = 0; c < 256; c++) {
+    res.value[c] = 36;
+  }
+  for (uint8_t d = 0; d < 36; d++) {
+    res.value[static_cast<uint8_t>(DIGIT_CHARS[d])] = d;
+    if (d >= 10) {
+      res.value[static_cast<uint8_t>(DIGIT_CHARS[d] - 'a' + 'A')] = d;
+    }
+  }
+  return res;
+}
+
+static constexpr digit_values DIGIT_VALUES = makeDigitValues();
+
+// Значение цифры в любом регистре, 36 для прочих символов
+static uint32_t digitValue(char c) {
+  return DIGIT_VALUES.value[static_cast<uint8_t>(c)];
+}
+
+// Основание системы счисления: digits цифр помещаются в разряд, power =
+// base^digits, bits = log2(base) для степеней двойки, иначе 0
+struct big_integer::radix {
+  uint32_t base;
+  size_t digits;
+  limb power;
+  uint32_t bits;
+};
+
+big_integer::radix big_integer::makeRadix(uint32_t base) {
+  if (base < 2 || base > 36) {
+    throw std::invalid_argument("Unsupported base");
+  }
+  radix r = {base, 0, 1, 0};
+  while (r.power <= std::numeric_limits<limb>::max() / base) {
+    r.power *= base;
+    r.digits++;
+  }
+  if ((base & (base - 1)) == 0) {
+    r.bits = __builtin_ctz(base);
+  }
+  return r;
+}
 
 big_integer::big_integer() : sign(0) {}
 
@@ -22,504 +124,3782 @@ big_integer::big_integer(long unsigned int a)
 
 void big_integer::pushBits(uint64_t a) {
   while (a != 0) {
-    num.push_back(a & std::numeric_limits<uint32_t>::max());
-    a >>= BASE;
+    num.push_back(static_cast<limb>(a));
+    a = static_cast<uint64_t>(static_cast<dlimb>(a) >> BASE);
   }
   fixLeadingBits();
 }
 
-big_integer::big_integer(long long a) : sign(a >= 0 ? 0 : 1) {
-  pushBits(a & std::numeric_limits<uint64_t>::max());
+big_integer::big_integer(long long a) : sign(0) {
+  setSmall(a);
 }
 
 big_integer::big_integer(long long unsigned a) : sign(0) {
-  pushBits(a & std::numeric_limits<uint64_t>::max());
+  if (a <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+    setSmall(static_cast<int64_t>(a));
+  } else {
+    pushBits(a);
+  }
 }
 
-big_integer::big_integer(std::string const& str) : sign(0) {
-  num.push_back(0);
-  if (str.size() == 0 || (str[0] == '-' && str.size() == 1)) {
-    throw std::invalid_argument("Got empty string in number constructor");
+bool big_integer::getSmall(int64_t& value) const {
+  if (num.size() > SMALL_LIMBS) {
+    return false;
   }
-  for (size_t i = str[0] == '-' ? 1 : 0; i < str.size(); i++) {
-    if (str[i] > '9' || str[i] < '0') {
-      throw std::invalid_argument("Wrong number format");
-    }
+  uint64_t bits = sign == 0 ? 0 : std::numeric_limits<uint64_t>::max();
+  for (size_t i = num.size(); i-- > 0;) {
+    bits = static_cast<uint64_t>((static_cast<dlimb>(bits) << BASE) | num[i]);
   }
-  for (size_t i = str[0] == '-' ? 1 : 0; i < str.size(); i += 9) {
-    uint32_t cur = 0;
-    uint32_t factor = 1;
-    for(size_t j = 0; j < std::min(str.size() - i, 9ul); j++, factor *= 10) {
-      cur *= 10;
-      cur += str[i + j] - '0';
-    }
-    mulShort(factor);
-    addShort(cur);
+  value = static_cast<int64_t>(bits);
+  return true;
+}
+
+void big_integer::setSmall(int64_t value) {
+  sign = value < 0 ? 1 : 0;
+  num.resize(SMALL_LIMBS, 0);
+  uint64_t bits = static_cast<uint64_t>(value);
+  for (size_t i = 0; i < SMALL_LIMBS; i++) {
+    num[i] = static_cast<limb>(bits);
+    bits = static_cast<uint64_t>(static_cast<dlimb>(bits) >> BASE);
   }
-  if (str[0] == '-') {
-    negate();
+  if (SMALL_LIMBS > 1) {
+    fixLeadingBits();
   }
-  fixLeadingBits();
 }
 
-big_integer& big_integer::operator=(big_integer const& other) {
-  big_integer(other).swap(*this);
-  return *this;
+// Встроенное целое помещается в int64_t
+static bool nativeFits(uint64_t bits, bool negative) {
+  return negative || bits <= static_cast<uint64_t>(
+                                 std::numeric_limits<int64_t>::max());
 }
 
-big_integer& big_integer::operator+=(big_integer const& rhs) {
-  uint32_t carry = 0;
-  size_t len = std::max(num.size(), rhs.num.size());
-  setLen(len + 1);
-  for (size_t i = 0; i < num.size(); i++) {
-    uint64_t sum = num[i];
-    sum += carry;
-    sum += (i < rhs.num.size() ? rhs.num[i] : rhs.signBits());
-    uint32_t temp = sum % (1ll << BASE);
-    num[i] = temp;
-    carry = sum >> BASE;
+big_integer::limb big_integer::nativeLimbs(native_int rhs, limb* out) {
+  uint64_t bits = rhs.bits;
+  for (size_t i = 0; i < SMALL_LIMBS; i++) {
+    out[i] = static_cast<limb>(bits);
+    bits = static_cast<uint64_t>(static_cast<dlimb>(bits) >> BASE);
   }
-  sign = leadingBit();
-  fixLeadingBits();
+  return rhs.negative ? std::numeric_limits<limb>::max() : 0;
+}
+
+big_integer big_integer::fromNative(native_int rhs) {
+  if (rhs.negative) {
+    return big_integer(static_cast<long long>(rhs.bits));
+  }
+  return big_integer(static_cast<unsigned long long>(rhs.bits));
+}
+
+// a op b для встроенного b, op -- обёртка над __builtin_*_overflow.
+// Возвращает true при переполнении int64_t
+template <typename F>
+static bool nativeOverflow(int64_t a, uint64_t bits, bool negative,
+                           int64_t& res, F op) {
+  return negative ? op(a, static_cast<int64_t>(bits), &res)
+                  : op(a, bits, &res);
+}
+
+big_integer& big_integer::addNative(native_int rhs) {
+  auto op = [](auto x, auto y, int64_t* r) {
+    return __builtin_add_overflow(x, y, r);
+  };
+  int64_t a, res;
+  if (getSmall(a) && !nativeOverflow(a, rhs.bits, rhs.negative, res, op)) {
+    setSmall(res);
+    return *this;
+  }
+  limb b[SMALL_LIMBS];
+  limb fill = nativeLimbs(rhs, b);
+  addLimbsSigned(b, SMALL_LIMBS, fill);
   return *this;
 }
 
-big_integer& big_integer::operator-=(big_integer const& rhs) {
-  uint64_t carry = 0;
-  size_t len = std::max(num.size(), rhs.num.size());
-  setLen(len + 1);
-  for (size_t i = 0; i < num.size(); i++) {
-    uint64_t diff = (1ull << BASE) + num[i];
-    diff -= carry + (i < rhs.num.size() ? rhs.num[i] : rhs.signBits());
-    num[i] = diff % (1ull << BASE);
-    carry = (diff >> BASE) ^ 1;
+big_integer& big_integer::subNative(native_int rhs) {
+  auto op = [](auto x, auto y, int64_t* r) {
+    return __builtin_sub_overflow(x, y, r);
+  };
+  int64_t a, res;
+  if (getSmall(a) && !nativeOverflow(a, rhs.bits, rhs.negative, res, op)) {
+    setSmall(res);
+    return *this;
   }
-  sign = leadingBit();
-  fixLeadingBits();
+  limb b[SMALL_LIMBS];
+  limb fill = nativeLimbs(rhs, b);
+  subLimbsSigned(b, SMALL_LIMBS, fill);
   return *this;
 }
 
-big_integer& big_integer::operator*=(big_integer const& rhs) {
-  uint8_t resSign = 0;
-  big_integer sec = rhs;
+big_integer& big_integer::mulNative(native_int rhs) {
+  auto op = [](auto x, auto y, int64_t* r) {
+    return __builtin_mul_overflow(x, y, r);
+  };
+  int64_t a, res;
+  if (getSmall(a) && !nativeOverflow(a, rhs.bits, rhs.negative, res, op)) {
+    setSmall(res);
+    return *this;
+  }
+  uint64_t abs = rhs.negative ? 0 - rhs.bits : rhs.bits;
+  if (abs > std::numeric_limits<limb>::max()) {
+    return *this *= fromNative(rhs);
+  }
+  bool negative = (sign != 0) != rhs.negative;
   if (sign != 0) {
     negate();
-    resSign ^= 1;
   }
-  if (rhs.sign != 0) {
-    sec.negate();
-    resSign ^= 1;
+  mulShort(static_cast<limb>(abs));
+  if (negative) {
+    negate();
   }
-  big_integer res;
-  res.setLen(num.size() + sec.num.size());
-  for (size_t i = 0; i < num.size(); i++) {
-    uint64_t carry = 0;
-    for (size_t j = 0; j < sec.num.size() || carry != 0; j++) {
-      uint64_t cur = 1ull * num[i] * (j < sec.num.size() ? sec.num[j] : 0);
-      cur += res.num[i + j] + carry;
-      res.num[i + j] = cur % (1ull << BASE);
-      carry = cur >> BASE;
+  return *this;
+}
+
+big_integer& big_integer::divRemNative(native_int rhs, bool remNeeded) {
+  int64_t a;
+  if (getSmall(a) && nativeFits(rhs.bits, rhs.negative)) {
+    int64_t b = static_cast<int64_t>(rhs.bits);
+    if (b != 0 && !(a == std::numeric_limits<int64_t>::min() && b == -1)) {
+      setSmall(remNeeded ? a % b : a / b);
+      return *this;
     }
   }
-  res.fixLeadingBits();
-  if (resSign != 0) {
-    res.negate();
+  uint64_t abs = rhs.negative ? 0 - rhs.bits : rhs.bits;
+  if (abs == 0 || abs > std::numeric_limits<limb>::max()) {
+    return divRemLong(fromNative(rhs), remNeeded);
+  }
+  // Частное со знаком произведения знаков, остаток со знаком делимого
+  bool negative = sign != 0;
+  if (negative) {
+    negate();
+  }
+  limb rem = divRemShort(static_cast<limb>(abs));
+  if (remNeeded) {
+    num.clear();
+    pushBits(rem);
+  } else {
+    negative = negative != rhs.negative;
+  }
+  if (negative) {
+    negate();
   }
-  res.fixLeadingBits();
-  *this = res;
   return *this;
 }
 
-big_integer& big_integer::addShort(uint32_t rhs) {
-  uint64_t carry = rhs;
-  setLen(num.size() + 1);
-  for (int32_t i = 0; i < num.size(); i++) {
-    if (i == num.size()) {
-      num.push_back(0);
-    }
-    uint64_t cur = num[i] + carry;
-    num[i] = cur % (1ull << BASE);
-    carry = (cur & (1ull << BASE)) >> BASE;
-  }
-  sign = leadingBit();
-  fixLeadingBits();
+big_integer::big_integer(big_integer&& other) noexcept
+    : sign(other.sign), num(std::move(other.num)) {
+  other.sign = 0;
+}
+
+big_integer& big_integer::operator=(big_integer const& other) {
+  big_integer(other).swap(*this);
   return *this;
 }
 
-big_integer& big_integer::subShort(uint32_t rhs) {
-  uint64_t carry = rhs;
-  setLen(num.size() + 1);
-  for (uint32_t& i : num) {
-    uint64_t diff = (1ull << BASE) + i;
-    diff -= carry;
-    i = diff % (1ull << BASE);
-    carry = (diff >> BASE) ^ 1;
+big_integer& big_integer::operator=(big_integer&& other) noexcept {
+  if (this != &other) {
+    num = std::move(other.num);
+    sign = other.sign;
+    other.sign = 0;
   }
-  sign = leadingBit();
-  fixLeadingBits();
   return *this;
 }
 
-uint32_t big_integer::divRemShort(uint32_t rhs) {
-  uint64_t carry = 0;
-  for (int32_t i = num.size() - 1; i >= 0; i--) {
-    uint64_t cur = num[i] + (carry << BASE);
-    num[i] = (cur / rhs) % (1ll << BASE);
-    carry = cur % rhs;
+big_integer& big_integer::operator+=(big_integer const& rhs) {
+  int64_t a, b, res;
+  if (getSmall(a) && rhs.getSmall(b) && !__builtin_add_overflow(a, b, &res)) {
+    setSmall(res);
+    return *this;
   }
-  fixLeadingBits();
-  return carry;
+  if (this == &rhs) {
+    return *this <<= 1;
+  }
+  addLimbsSigned(rhs.num.data(), rhs.num.size(), rhs.signBits());
+  return *this;
 }
 
-big_integer& big_integer::mulShort(uint32_t rhs) {
-  uint64_t carry = 0;
-  for (int32_t i = 0; i < num.size() || carry != 0; i++) {
-    if (i == num.size()) {
-      num.push_back(0);
-    }
-    uint64_t cur = 1ull * num[i] * rhs + carry;
-    num[i] = cur % (1ull << BASE);
-    carry = cur >> BASE;
+big_integer& big_integer::operator-=(big_integer const& rhs) {
+  int64_t a, b, res;
+  if (getSmall(a) && rhs.getSmall(b) && !__builtin_sub_overflow(a, b, &res)) {
+    setSmall(res);
+    return *this;
   }
-  fixLeadingBits();
+  if (this == &rhs) {
+    setSmall(0);
+    return *this;
+  }
+  subLimbsSigned(rhs.num.data(), rhs.num.size(), rhs.signBits());
   return *this;
 }
 
-int32_t big_integer::normalize() {
-  uint32_t first = num.back();
-  int32_t res = 0;
-  if (first == 0) {
-    res = BASE - 1;
-  } else {
-    while (first < (1ull << (BASE - 1))) {
-      first <<= 1;
-      res++;
-    }
+void big_integer::addLimbsSigned(limb const* b, size_t m, limb fill) {
+  limb carry = 0;
+  limb top = signBits();
+  setLen(std::max(num.size(), m));
+  for (size_t i = 0; i < num.size(); i++) {
+    dlimb sum = num[i];
+    sum += carry;
+    sum += (i < m ? b[i] : fill);
+    num[i] = static_cast<limb>(sum);
+    carry = static_cast<limb>(sum >> BASE);
   }
-  *this <<= res;
-  return res;
+  // Старший разряд дописывается, только если он не совпадает с
+  // расширением знака: так результат не переезжает в новый буфер зря
+  pushHigh(static_cast<limb>(top + fill + carry));
 }
 
-big_integer& big_integer::divRemLong(const big_integer& rhs, bool remNeeded) {
-  uint8_t resSign = 0;
-  big_integer b = rhs;
-  if (*this < 0) {
-    negate();
-    resSign ^= 1;
+void big_integer::subLimbsSigned(limb const* b, size_t m, limb fill) {
+  dlimb carry = 0;
+  limb top = signBits();
+  setLen(std::max(num.size(), m));
+  for (size_t i = 0; i < num.size(); i++) {
+    dlimb diff = (static_cast<dlimb>(1) << BASE) + num[i];
+    diff -= carry + (i < m ? b[i] : fill);
+    num[i] = static_cast<limb>(diff);
+    carry = (diff >> BASE) ^ 1;
   }
-  if (b < 0) {
-    b.negate();
-    resSign ^= 1;
+  pushHigh(static_cast<limb>(top - fill - static_cast<limb>(carry)));
+}
+
+void big_integer::pushHigh(limb high) {
+  sign = high >> (BASE - 1);
+  if (high != signBits() || leadingBit() != sign) {
+    num.push_back(high);
   }
-  if (*this < b) {
-    if (!remNeeded) {
-      *this = 0;
-    }
-    if ((resSign ^ rhs.sign) != 0) {
-      negate();
-    }
-    return *this;
+  fixLeadingBits();
+}
+
+// Пороги выбора алгоритма умножения по числу разрядов меньшего множителя:
+// в столбик, Карацуба, Тоом-3, преобразование Фурье по простым модулям.
+// Подобраны с помощью benchmark.cpp
+#ifndef BIGINT_KARATSUBA_THRESHOLD
+#define BIGINT_KARATSUBA_THRESHOLD 32
+#endif
+#ifndef BIGINT_TOOM3_THRESHOLD
+#define BIGINT_TOOM3_THRESHOLD 128
+#endif
+#ifndef BIGINT_NTT_THRESHOLD
+#define BIGINT_NTT_THRESHOLD 2048
+#endif
+static const size_t KARATSUBA_THRESHOLD = BIGINT_KARATSUBA_THRESHOLD;
+static const size_t TOOM3_THRESHOLD = BIGINT_TOOM3_THRESHOLD;
+static const size_t NTT_THRESHOLD = BIGINT_NTT_THRESHOLD;
+
+// Умножения, где меньший множитель не короче этого, делят преобразование
+// Фурье между потоками, если их задано больше одного
+#ifndef BIGINT_PARALLEL_THRESHOLD
+#define BIGINT_PARALLEL_THRESHOLD 32768
+#endif
+static const size_t PARALLEL_THRESHOLD = BIGINT_PARALLEL_THRESHOLD;
+
+// Пороги выбора алгоритма деления по числу разрядов делителя: в столбик,
+// рекурсивное деление Бурникеля-Циглера, через обратное по Ньютону
+#ifndef BIGINT_BZ_DIVISION_THRESHOLD
+#define BIGINT_BZ_DIVISION_THRESHOLD 256
+#endif
+#ifndef BIGINT_NEWTON_DIVISION_THRESHOLD
+#define BIGINT_NEWTON_DIVISION_THRESHOLD 65536
+#endif
+static const size_t BZ_DIVISION_THRESHOLD = BIGINT_BZ_DIVISION_THRESHOLD;
+static const size_t NEWTON_DIVISION_THRESHOLD =
+    BIGINT_NEWTON_DIVISION_THRESHOLD;
+
+// Числа не длиннее этого переводятся в запись по основанию b делением на
+// b^d, d -- число цифр в разряде, более длинные делятся пополам на
+// степени b^(d * 2^k). Основания-степени двойки переводятся по битам
+#ifndef BIGINT_TO_STRING_THRESHOLD
+#define BIGINT_TO_STRING_THRESHOLD 128
+#endif
+static const size_t TO_STRING_THRESHOLD = BIGINT_TO_STRING_THRESHOLD;
+
+// Записи не длиннее d * FROM_STRING_THRESHOLD цифр разбираются умножением
+// на b^d, более длинные делятся пополам по степеням b^(d * 2^k)
+#ifndef BIGINT_FROM_STRING_THRESHOLD
+#define BIGINT_FROM_STRING_THRESHOLD 64
+#endif
+static const size_t FROM_STRING_THRESHOLD = BIGINT_FROM_STRING_THRESHOLD;
+
+// Половинный НОД рекурсивно приводит старшие половины чисел не короче
+// HGCD_THRESHOLD, более короткие -- шагами Лемера. НОД чисел не короче
+// GCD_HGCD_THRESHOLD считается через половинный НОД
+#ifndef BIGINT_HGCD_THRESHOLD
+#define BIGINT_HGCD_THRESHOLD 128
+#endif
+static const size_t HGCD_THRESHOLD = BIGINT_HGCD_THRESHOLD;
+#ifndef BIGINT_GCD_HGCD_THRESHOLD
+#define BIGINT_GCD_HGCD_THRESHOLD 2048
+#endif
+static const size_t GCD_HGCD_THRESHOLD = BIGINT_GCD_HGCD_THRESHOLD;
+
+// Приведение по Барретту для модулей короче этого считает в столбик
+// только нужные столбцы произведений, для более длинных -- произведения
+// целиком
+#ifndef BIGINT_BARRETT_SHORT_THRESHOLD
+#define BIGINT_BARRETT_SHORT_THRESHOLD 128
+#endif
+static const size_t BARRETT_SHORT_THRESHOLD = BIGINT_BARRETT_SHORT_THRESHOLD;
+
+// a[0, n) += b[0, m), m <= n, возвращает перенос из старшего разряда
+static limb addLimbs(limb* a, size_t n, limb const* b, size_t m) {
+  dlimb carry = 0;
+  size_t i = 0;
+  for (; i < m; i++) {
+    carry += static_cast<dlimb>(a[i]) + b[i];
+    a[i] = static_cast<limb>(carry);
+    carry >>= BASE;
   }
-  int32_t shift = b.normalize();
-  *this <<= shift;
-  uint32_t n = b.num.size();
-  while (b.num[n - 1] == b.signBits()) {
-    n--;
+  for (; carry != 0 && i < n; i++) {
+    carry += a[i];
+    a[i] = static_cast<limb>(carry);
+    carry >>= BASE;
   }
-  uint64_t nLast = b.num[n - 1];
-  uint32_t m = num.size() - n;
-  big_integer res = 0;
-  b <<= BASE * m;
-  if (*this >= b) {
-    res++;
-    *this -= b;
+  return static_cast<limb>(carry);
+}
+
+// a[0, n) = a[0, n) * mul + add, возвращает перенос из старшего разряда
+static limb mulAddShort(limb* a, size_t n, limb mul,
+                            limb add) {
+  dlimb carry = add;
+  for (size_t i = 0; i < n; i++) {
+    carry += static_cast<dlimb>(a[i]) * mul;
+    a[i] = static_cast<limb>(carry);
+    carry >>= BASE;
   }
-  for (int32_t i = m - 1; i >= 0; i--) {
-    b >>= BASE;
-    uint64_t cur = ((1ll * num[n + i] << BASE) + num[n + i - 1]) / nLast;
-    cur = std::min(cur,
-                   static_cast<uint64_t>(std::numeric_limits<uint32_t>::max()));
-    *this -= cur * b;
-    while (sign != 0) {
-      cur--;
-      *this += b;
-    }
-    res <<= BASE;
-    res.addShort(cur);
+  return static_cast<limb>(carry);
+}
+
+// a[0, n) -= b[0, m), m <= n, возвращает заём из старшего разряда
+static limb subLimbs(limb* a, size_t n, limb const* b, size_t m) {
+  dlimb borrow = 0;
+  size_t i = 0;
+  for (; i < m; i++) {
+    dlimb diff = static_cast<dlimb>(a[i]) - b[i] - borrow;
+    a[i] = static_cast<limb>(diff);
+    borrow = (diff >> BASE) & 1;
   }
-  if (!remNeeded) {
-    if (resSign != 0) {
-      res.negate();
-    }
-    res.fixLeadingBits();
-    *this = res;
-  } else {
-    *this >>= shift;
-    if ((resSign ^ rhs.sign) != 0) {
-      negate();
-    }
+  for (; borrow != 0 && i < n; i++) {
+    borrow = a[i] == 0 ? 1 : 0;
+    a[i]--;
   }
-  return *this;
+  return static_cast<limb>(borrow);
 }
 
-big_integer& big_integer::operator/=(big_integer const& rhs) {
-  return divRemLong(rhs, false);
+// a[0, m) -= b[0, m) * q, возвращает заём из старшего разряда
+static limb subMulShort(limb* a, limb const* b, size_t m, limb q) {
+  limb borrow = 0;
+  for (size_t i = 0; i < m; i++) {
+    dlimb prod = static_cast<dlimb>(b[i]) * q + borrow;
+    limb low = static_cast<limb>(prod);
+    borrow = static_cast<limb>(prod >> BASE) + (a[i] < low ? 1 : 0);
+    a[i] -= low;
+  }
+  return borrow;
 }
 
-big_integer& big_integer::operator%=(big_integer const& rhs) {
-  return divRemLong(rhs, true);
+// a[0, n) < b[0, n)
+static bool lessLimbs(limb const* a, limb const* b, size_t n) {
+  for (size_t i = n; i-- > 0;) {
+    if (a[i] != b[i]) {
+      return a[i] < b[i];
+    }
+  }
+  return false;
 }
 
-template <typename F>
-void big_integer::makeBinaryBitOp(const big_integer& rhs, F func) {
-  size_t len = std::max(num.size(), rhs.num.size());
-  setLen(len + 1);
-  for (size_t i = 0; i < num.size(); i++) {
-    num[i] = func(num[i], i < rhs.num.size() ? rhs.num[i] : rhs.signBits());
+// out[0, n) = a[0, n) << shift, 0 <= shift < BASE, возвращает выдвинутые
+// биты
+static limb shlLimbs(limb const* a, size_t n, uint32_t shift, limb* out) {
+  if (shift == 0) {
+    std::copy(a, a + n, out);
+    return 0;
   }
-  sign = leadingBit();
-  fixLeadingBits();
+  limb carry = 0;
+  for (size_t i = 0; i < n; i++) {
+    limb cur = a[i];
+    out[i] = (cur << shift) | carry;
+    carry = cur >> (BASE - shift);
+  }
+  return carry;
 }
 
-big_integer& big_integer::operator&=(big_integer const& rhs) {
-  makeBinaryBitOp(rhs, [](uint32_t a, uint32_t b) { return a & b; });
-  return *this;
+// a[0, n) >>= shift, 0 <= shift < BASE
+static void shrLimbs(limb* a, size_t n, uint32_t shift) {
+  if (shift == 0) {
+    return;
+  }
+  for (size_t i = 0; i + 1 < n; i++) {
+    a[i] = (a[i] >> shift) | (a[i + 1] << (BASE - shift));
+  }
+  a[n - 1] >>= shift;
 }
 
-big_integer& big_integer::operator|=(big_integer const& rhs) {
-  makeBinaryBitOp(rhs, [](uint32_t a, uint32_t b) { return a | b; });
-  return *this;
+static uint32_t leadingZeros(limb x) {
+  return __builtin_clzll(x) - (64 - BASE);
 }
 
-big_integer& big_integer::operator^=(big_integer const& rhs) {
-  makeBinaryBitOp(rhs, [](uint32_t a, uint32_t b) { return a ^ b; });
-  return *this;
+// Обратное к делителю (d1, d0) со старшим битом 1 для деления 3 на 2
+// разряда умножением (Мёллер, Гранлунд): floor((B^3 - 1) / (d1, d0)) - B
+static limb reciprocalThreeByTwo(limb d1, limb d0) {
+  limb v = static_cast<limb>(
+      (~static_cast<dlimb>(0) - (static_cast<dlimb>(d1) << BASE)) / d1);
+  limb p = d1 * v + d0;
+  if (p < d0) {
+    v--;
+    if (p >= d1) {
+      v--;
+      p -= d1;
+    }
+    p -= d1;
+  }
+  dlimb t = static_cast<dlimb>(v) * d0;
+  limb t1 = static_cast<limb>(t >> BASE);
+  p += t1;
+  if (p < t1) {
+    v--;
+    if (p > d1 || (p == d1 && static_cast<limb>(t) >= d0)) {
+      v--;
+    }
+  }
+  return v;
 }
 
-big_integer& big_integer::operator<<=(int rhs) {
-  setLen(num.size() + (rhs + BASE - 1) / BASE);
-  int32_t mod = rhs % BASE;
-  if (mod != 0) {
-    uint64_t carry = 0;
-    for (uint32_t& i : num) {
-      uint64_t temp = (i & (((1u << mod) - 1) << (BASE - mod))) >> (BASE - mod);
-      i = (i << mod) + carry;
-      carry = temp;
-    }
+// Частное (a2, a1, a0) на (d1, d0) при (a2, a1) < (d1, d0), v -- обратное
+// из reciprocalThreeByTwo. Остаток записывается в rem
+static limb divThreeByTwoLimbs(limb a2, limb a1, limb a0, limb d1, limb d0,
+                               limb v, dlimb& rem) {
+  dlimb d = (static_cast<dlimb>(d1) << BASE) | d0;
+  dlimb q = static_cast<dlimb>(a2) * v +
+            ((static_cast<dlimb>(a2) << BASE) | a1);
+  limb q1 = static_cast<limb>(q >> BASE);
+  limb q0 = static_cast<limb>(q);
+  limb r1 = a1 - d1 * q1;
+  rem = ((static_cast<dlimb>(r1) << BASE) | a0) - d -
+        static_cast<dlimb>(d0) * q1;
+  q1++;
+  // Оценка больше частного не более чем на 2, исправления без ветвлений
+  // в вероятном случае
+  if (static_cast<limb>(rem >> BASE) >= q0) {
+    q1--;
+    rem += d;
   }
-  for (int32_t i = num.size() - 1; i >= (int32_t)(rhs / BASE); i--) {
-    num[i] = num[i - rhs / BASE];
+  if (rem >= d) {
+    q1++;
+    rem -= d;
   }
-  for (int32_t i = rhs / BASE - 1; i >= 0; i--) {
-    num[i] = 0;
+  return q1;
+}
+
+// Деление a[0, n + m) на b[0, m), m >= 2, старший бит b равен 1 и
+// a[n + m - 1] < b[m - 1] (алгоритм D Кнута). Разряды частного в q[0, n),
+// остаток в a[0, m)
+static void divSchool(limb* a, size_t n, limb const* b, size_t m, limb* q) {
+  limb d1 = b[m - 1];
+  limb d0 = b[m - 2];
+  limb v = reciprocalThreeByTwo(d1, d0);
+  for (size_t j = n; j-- > 0;) {
+    limb* cur = a + j;
+    limb high = cur[m - 1];
+    limb res;
+    if (cur[m] == d1 && high == d0) {
+      // Верная цифра частного -- B - 1
+      res = std::numeric_limits<limb>::max();
+      subMulShort(cur, b, m, res);
+      high = cur[m - 1];
+    } else {
+      dlimb rem;
+      res = divThreeByTwoLimbs(cur[m], high, cur[m - 2], d1, d0, v, rem);
+      // Оценка по трём старшим разрядам больше цифры частного не более
+      // чем на 1: вычитаем остальные разряды и при заёме прибавляем b
+      limb borrow = subMulShort(cur, b, m - 2, res);
+      limb low = static_cast<limb>(rem);
+      high = static_cast<limb>(rem >> BASE);
+      limb borrowLow = low < borrow ? 1 : 0;
+      low -= borrow;
+      limb borrowHigh = high < borrowLow ? 1 : 0;
+      high -= borrowLow;
+      cur[m - 2] = low;
+      if (borrowHigh != 0) {
+        high += d1 + addLimbs(cur, m - 1, b, m - 1);
+        res--;
+      }
+    }
+    cur[m - 1] = high;
+    cur[m] = 0;
+    q[j] = res;
   }
-  fixLeadingBits();
-  return *this;
 }
 
-big_integer& big_integer::operator>>=(int rhs) {
-  setLen(num.size() + (rhs + BASE - 1) / BASE);
-  uint32_t carry = 0;
-  int mod = rhs % BASE;
-  if (mod != 0) {
-    for (int32_t i = num.size() - 1; i >= 0; i--) {
-      uint32_t temp = num[i] & ((1u << mod) - 1);
-      num[i] = (num[i] >> mod) + (carry << (BASE - mod));
-      carry = temp;
+// res[0, n + m) = a[0, n) * b[0, m), в столбик
+static void mulSchool(limb const* a, size_t n, limb const* b, size_t m,
+                      limb* res) {
+  std::fill(res, res + n + m, 0);
+  for (size_t i = 0; i < n; i++) {
+    dlimb carry = 0;
+    for (size_t j = 0; j < m; j++) {
+      carry += static_cast<dlimb>(a[i]) * b[j] + res[i + j];
+      res[i + j] = static_cast<limb>(carry);
+      carry >>= BASE;
     }
+    res[i + m] = static_cast<limb>(carry);
   }
-  for (size_t i = 0; i < num.size() - (rhs + BASE - 1) / BASE; i++) {
-    num[i] = num[i + rhs / BASE];
+}
+
+// res[0, 2n) = a[0, n)^2: попарные произведения считаются один раз и
+// удваиваются, затем добавляются квадраты разрядов
+static void sqrSchool(limb const* a, size_t n, limb* res) {
+  if (n == 0) {
+    return;
   }
-  for (size_t i = 0; i < (rhs + BASE - 1) / BASE; i++) {
-    num.pop_back();
+  std::fill(res, res + 2 * n, 0);
+  for (size_t i = 0; i < n; i++) {
+    dlimb carry = 0;
+    for (size_t j = i + 1; j < n; j++) {
+      carry += static_cast<dlimb>(a[i]) * a[j] + res[i + j];
+      res[i + j] = static_cast<limb>(carry);
+      carry >>= BASE;
+    }
+    res[i + n] = static_cast<limb>(carry);
+  }
+  for (size_t i = 2 * n - 1; i > 0; i--) {
+    res[i] = (res[i] << 1) | (res[i - 1] >> (BASE - 1));
+  }
+  res[0] <<= 1;
+  dlimb carry = 0;
+  for (size_t i = 0; i < n; i++) {
+    dlimb square = static_cast<dlimb>(a[i]) * a[i];
+    carry += static_cast<dlimb>(res[2 * i]) + static_cast<limb>(square);
+    res[2 * i] = static_cast<limb>(carry);
+    carry >>= BASE;
+    carry += static_cast<dlimb>(res[2 * i + 1]) + (square >> BASE);
+    res[2 * i + 1] = static_cast<limb>(carry);
+    carry >>= BASE;
   }
-  fixLeadingBits();
-  return *this;
 }
 
-big_integer big_integer::operator+() const {
-  return *this;
+// Размер буфера, которого хватает mulKaratsuba для множителей длины n
+static size_t karatsubaScratch(size_t n) {
+  size_t res = 0;
+  while (n >= KARATSUBA_THRESHOLD) {
+    size_t k = (n + 1) / 2;
+    res += 4 * k + 4;
+    n = k + 1;
+  }
+  return res;
 }
 
-void big_integer::invert() {
-  sign ^= 1;
-  for (uint32_t& i : num) {
-    i = ~i;
+static void mulRec(limb const* a, size_t n, limb const* b, size_t m,
+                   limb* res, limb* scratch);
+
+// Множители сильно разной длины (n >= 2m): режем a на куски длины m
+static void mulUnbalanced(limb const* a, size_t n, limb const* b,
+                          size_t m, limb* res) {
+  vector<limb> buf;
+  buf.resize(2 * m + karatsubaScratch(m), 0);
+  std::fill(res, res + n + m, 0);
+  for (size_t i = 0; i < n; i += m) {
+    size_t len = std::min(m, n - i);
+    mulRec(a + i, len, b, m, buf.data(), buf.data() + 2 * m);
+    addLimbs(res + i, n + m - i, buf.data(), len + m);
   }
-  fixLeadingBits();
 }
 
-void big_integer::negate() {
-  if (*this != 0) {
-    invert();
-    addShort(1);
+// a = a1 * X + a0, b = b1 * X + b0, X = 2^(BASE * k)
+// a * b = a1 * b1 * X^2 + ((a0 + a1)(b0 + b1) - a0 * b0 - a1 * b1) * X + a0 * b0
+// Требует n >= m > k = ceil(n / 2). При a == b все три произведения -- квадраты
+static void mulKaratsuba(limb const* a, size_t n, limb const* b,
+                         size_t m, limb* res, limb* scratch) {
+  size_t k = (n + 1) / 2;
+  mulRec(a, k, b, k, res, scratch);
+  mulRec(a + k, n - k, b + k, m - k, res + 2 * k, scratch);
+
+  limb* sa = scratch;
+  limb* sb = sa + k + 1;
+  limb* mid = sb + k + 1;
+  std::copy(a, a + k, sa);
+  sa[k] = addLimbs(sa, k, a + k, n - k);
+  if (a == b) {
+    sb = sa;
+  } else {
+    std::copy(b, b + k, sb);
+    sb[k] = addLimbs(sb, k, b + k, m - k);
   }
+  mulRec(sa, k + 1, sb, k + 1, mid, mid + 2 * k + 2);
+
+  subLimbs(mid, 2 * k + 2, res, 2 * k);
+  subLimbs(mid, 2 * k + 2, res + 2 * k, n + m - 2 * k);
+  // Средний член меньше 2^(BASE * (n + m - k)), старшие разряды mid нулевые
+  addLimbs(res + k, n + m - k, mid, std::min(2 * k + 2, n + m - k));
 }
 
-big_integer big_integer::operator-() const {
-  big_integer res(*this);
-  res.negate();
-  res.fixLeadingBits();
-  return res;
+// Арифметика в дополнении до двух по модулю 2^(BASE * len)
+static bool isNegative(limb const* a, size_t len) {
+  return (a[len - 1] >> (BASE - 1)) != 0;
 }
 
-big_integer big_integer::operator~() const {
-  big_integer res = *this;
-  res.invert();
-  return res;
+static void negLimbs(limb* a, size_t len) {
+  dlimb carry = 1;
+  for (size_t i = 0; i < len; i++) {
+    carry += static_cast<limb>(~a[i]);
+    a[i] = static_cast<limb>(carry);
+    carry >>= BASE;
+  }
 }
 
-big_integer& big_integer::operator++() {
-  addShort(1);
-  return *this;
+static void shlOne(limb* a, size_t len) {
+  for (size_t i = len - 1; i > 0; i--) {
+    a[i] = (a[i] << 1) | (a[i - 1] >> (BASE - 1));
+  }
+  a[0] <<= 1;
 }
 
-big_integer big_integer::operator++(int) {
-  big_integer res = *this;
-  ++*this;
-  return res;
+static void sarOne(limb* a, size_t len) {
+  for (size_t i = 0; i + 1 < len; i++) {
+    a[i] = (a[i] >> 1) | (a[i + 1] << (BASE - 1));
+  }
+  a[len - 1] = (a[len - 1] >> 1) | (a[len - 1] & (limb(1) << (BASE - 1)));
 }
 
-big_integer& big_integer::operator--() {
-  subShort(1);
-  return *this;
+// Точное деление на 3: умножение на обратный к 3 по модулю 2^BASE
+static void divExactByThree(limb* a, size_t len) {
+  const limb THIRD = std::numeric_limits<limb>::max() / 3;
+  const limb INV3 = 2 * THIRD + 1;
+  limb borrow = 0;
+  for (size_t i = 0; i < len; i++) {
+    limb x = a[i];
+    limb q = (x - borrow) * INV3;
+    borrow = (x < borrow ? 1 : 0) + (q > THIRD ? 1 : 0) +
+             (q > 2 * THIRD ? 1 : 0);
+    a[i] = q;
+  }
 }
 
-big_integer big_integer::operator--(int) {
-  big_integer res = *this;
-  --*this;
+// p1 = a(1), pm1 = a(-1), pm2 = a(-2) для a(x) = a2 * x^2 + a1 * x + a0
+static void toom3Evaluate(limb const* a, size_t n, size_t k, limb* p1,
+                          limb* pm1, limb* pm2, size_t len) {
+  std::fill(p1, p1 + len, 0);
+  std::copy(a, a + k, p1);
+  addLimbs(p1, len, a + 2 * k, n - 2 * k);
+  std::copy(p1, p1 + len, pm1);
+  subLimbs(pm1, len, a + k, k);
+  addLimbs(p1, len, a + k, k);
+  std::copy(pm1, pm1 + len, pm2);
+  addLimbs(pm2, len, a + 2 * k, n - 2 * k);
+  shlOne(pm2, len);
+  subLimbs(pm2, len, a, k);
+}
+
+// res[0, 2 * len) = a * b для a и b длины len со знаком, портит a и b.
+// a и b могут совпадать
+static void mulSigned(limb* a, limb* b, size_t len, limb* res,
+                      limb* scratch) {
+  bool negative = isNegative(a, len) != isNegative(b, len);
+  if (isNegative(a, len)) {
+    negLimbs(a, len);
+  }
+  if (b != a && isNegative(b, len)) {
+    negLimbs(b, len);
+  }
+  mulRec(a, len - 1, b, len - 1, res, scratch);
+  res[2 * len - 2] = res[2 * len - 1] = 0;
+  if (negative) {
+    negLimbs(res, 2 * len);
+  }
+}
+
+// a = a2 * X^2 + a1 * X + a0, X = 2^(BASE * k), аналогично b.
+// Произведение считается в точках 0, 1, -1, -2, inf и интерполируется
+// по схеме Бодрато. Требует n >= m > 2k, k = ceil(n / 3). При a == b
+// значения b не вычисляются, а произведения становятся квадратами
+static void mulToom3(limb const* a, size_t n, limb const* b, size_t m,
+                     limb* res) {
+  size_t k = (n + 2) / 3;
+  // |a(-2)| < 7 * X, поэтому двух дополнительных разрядов хватает со знаком
+  size_t pl = k + 2;
+  size_t rl = 2 * pl;
+  vector<limb> buf;
+  buf.resize(6 * pl + 3 * rl + karatsubaScratch(pl), 0);
+  limb* pa1 = buf.data();
+  limb* pam1 = pa1 + pl;
+  limb* pam2 = pam1 + pl;
+  limb* pb1 = pam2 + pl;
+  limb* pbm1 = pb1 + pl;
+  limb* pbm2 = pbm1 + pl;
+  limb* r1 = pbm2 + pl;
+  limb* rm1 = r1 + rl;
+  limb* rm2 = rm1 + rl;
+  limb* scratch = rm2 + rl;
+
+  toom3Evaluate(a, n, k, pa1, pam1, pam2, pl);
+  if (a == b) {
+    pb1 = pa1;
+    pbm1 = pam1;
+    pbm2 = pam2;
+  } else {
+    toom3Evaluate(b, m, k, pb1, pbm1, pbm2, pl);
+  }
+  mulSigned(pa1, pb1, pl, r1, scratch);
+  mulSigned(pam1, pbm1, pl, rm1, scratch);
+  mulSigned(pam2, pbm2, pl, rm2, scratch);
+
+  limb* r0 = res;
+  limb* rinf = res + 4 * k;
+  size_t infLen = n + m - 4 * k;
+  mulRec(a, k, b, k, r0, scratch);
+  mulRec(a + 2 * k, n - 2 * k, b + 2 * k, m - 2 * k, rinf, scratch);
+  std::fill(res + 2 * k, res + 4 * k, 0);
+
+  // rm2 = (r(-2) - r(1)) / 3
+  subLimbs(rm2, rl, r1, rl);
+  divExactByThree(rm2, rl);
+  // r1 = (r(1) - r(-1)) / 2
+  subLimbs(r1, rl, rm1, rl);
+  sarOne(r1, rl);
+  // rm1 = r(-1) - r(0)
+  subLimbs(rm1, rl, r0, 2 * k);
+  // rm2 = (rm1 - rm2) / 2 + 2 * r(inf)
+  negLimbs(rm2, rl);
+  addLimbs(rm2, rl, rm1, rl);
+  sarOne(rm2, rl);
+  addLimbs(rm2, rl, rinf, infLen);
+  addLimbs(rm2, rl, rinf, infLen);
+  // rm1 = rm1 + r1 - r(inf)
+  addLimbs(rm1, rl, r1, rl);
+  subLimbs(rm1, rl, rinf, infLen);
+  // r1 = r1 - rm2
+  subLimbs(r1, rl, rm2, rl);
+
+  // Коэффициенты неотрицательны и помещаются в результат, лишние разряды нулевые
+  addLimbs(res + k, n + m - k, r1, std::min(rl, n + m - k));
+  addLimbs(res + 2 * k, n + m - 2 * k, rm1, std::min(rl, n + m - 2 * k));
+  addLimbs(res + 3 * k, n + m - 3 * k, rm2, std::min(rl, n + m - 3 * k));
+}
+
+// Пул потоков для параллельных циклов. Это общая очередь без перехвата
+// задач: номера задач цикла раздаются по одной под общим мьютексом, и
+// вызвавший цикл поток берёт их наравне с рабочими. Параллельны только
+// проходы преобразования Фурье -- несколько десятков равных по объёму
+// задач по тысячам разрядов на каждую, так что взятие задачи под
+// мьютексом теряется на их фоне, а перекоса нагрузки, ради которого
+// нужны очереди на поток с перехватом, нет. Вложенный цикл не ждёт
+// освободившегося потока, а сам выполняет то, что не забрали другие
+struct thread_pool {
+  explicit thread_pool(size_t threads) : stop(false) {
+    for (size_t i = 1; i < threads; i++) {
+      workers.emplace_back([this] { work(); });
+    }
+  }
+
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : workers) {
+      t.join();
+    }
+  }
+
+  size_t threads() const {
+    return workers.size() + 1;
+  }
+
+  // fn(0), ..., fn(count - 1) в любом порядке и любых потоках, fn не
+  // должна бросать исключений
+  void run(size_t count, std::function<void(size_t)> const& fn) {
+    job j = {&fn, count, 0, 0};
+    std::unique_lock<std::mutex> lock(mutex);
+    jobs.push_back(&j);
+    wake.notify_all();
+    while (j.next < count) {
+      size_t i = take(&j);
+      lock.unlock();
+      fn(i);
+      lock.lock();
+      j.done++;
+    }
+    finished.wait(lock, [&] { return j.done == count; });
+  }
+
+private:
+  struct job {
+    std::function<void(size_t)> const* fn;
+    size_t count;
+    size_t next;
+    size_t done;
+  };
+
+  // Под мьютексом: номер следующей задачи, исчерпанный цикл убирается
+  size_t take(job* j) {
+    size_t i = j->next++;
+    if (j->next == j->count) {
+      jobs.erase(std::find(jobs.begin(), jobs.end(), j));
+    }
+    return i;
+  }
+
+  void work() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+      wake.wait(lock, [&] { return stop || !jobs.empty(); });
+      if (stop) {
+        return;
+      }
+      job* j = jobs.front();
+      size_t i = take(j);
+      lock.unlock();
+      (*j->fn)(i);
+      lock.lock();
+      // После последней задачи цикл может закончиться, и j пропадёт
+      if (++j->done == j->count) {
+        finished.notify_all();
+      }
+    }
+  }
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable finished;
+  std::vector<job*> jobs;
+  std::vector<std::thread> workers;
+  bool stop;
+};
+
+static std::unique_ptr<thread_pool> pool;
+
+void set_multiplication_threads(size_t threads) {
+  if (threads == 0) {
+    threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  }
+  pool.reset();
+  if (threads > 1) {
+    pool.reset(new thread_pool(threads));
+  }
+}
+
+size_t multiplication_threads() {
+  return pool ? pool->threads() : 1;
+}
+
+// fn(0), ..., fn(count - 1), в пуле, если он есть
+static void parallelFor(size_t count,
+                        std::function<void(size_t)> const& fn) {
+  if (count == 1 || !pool) {
+    for (size_t i = 0; i < count; i++) {
+      fn(i);
+    }
+  } else {
+    pool->run(count, fn);
+  }
+}
+
+// Три простых вида c * 2^k + 1, k >= 55, и их первообразные корни.
+// Произведение простых больше 2^183, поэтому свёртка 64-битных цифр длины
+// до 2^55 восстанавливается по китайской теореме об остатках точно
+static const uint64_t NTT_PRIMES[3] = {4179340454199820289ull,
+                                       2485986994308513793ull,
+                                       2053641430080946177ull};
+static const uint64_t NTT_ROOTS[3] = {3, 5, 7};
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+// Вычеты по простому модулю mod < 2^62, умножение по Монтгомери
+struct ntt_field {
+  uint64_t mod;
+  uint64_t negInv; // -mod^(-1) mod 2^64
+  uint64_t r2;     // 2^128 mod mod
+
+  explicit ntt_field(uint64_t mod) : mod(mod) {
+    uint64_t inv = mod;
+    for (int i = 0; i < 5; i++) {
+      inv *= 2 - mod * inv;
+    }
+    negInv = -inv;
+    uint128_t r = (static_cast<uint128_t>(1) << 64) % mod;
+    r2 = static_cast<uint64_t>(r * r % mod);
+  }
+
+  // a * b * 2^(-64) mod mod, требует a * b < mod * 2^64
+  uint64_t mul(uint64_t a, uint64_t b) const {
+    uint128_t t = static_cast<uint128_t>(a) * b;
+    uint64_t k = static_cast<uint64_t>(t) * negInv;
+    uint64_t res = static_cast<uint64_t>(
+        (t + static_cast<uint128_t>(k) * mod) >> 64);
+    return res >= mod ? res - mod : res;
+  }
+
+  uint64_t add(uint64_t a, uint64_t b) const {
+    uint64_t res = a + b;
+    return res >= mod ? res - mod : res;
+  }
+
+  uint64_t sub(uint64_t a, uint64_t b) const {
+    return a >= b ? a - b : a + mod - b;
+  }
+
+  // Представление Монтгомери: x * 2^64 mod mod
+  uint64_t toMont(uint64_t x) const {
+    return mul(x % mod, r2);
+  }
+
+  // Степень числа в представлении Монтгомери
+  uint64_t pow(uint64_t x, uint64_t e) const {
+    uint64_t res = toMont(1);
+    for (; e != 0; e >>= 1, x = mul(x, x)) {
+      if ((e & 1) != 0) {
+        res = mul(res, x);
+      }
+    }
+    return res;
+  }
+};
+
+// tw[h + j] = w^j для первообразного корня w степени 2h, h = 1, 2, ..., len / 2.
+// Старшие степени считаются tasks кусками, каждый от своей степени w
+static void nttRoots(ntt_field const& f, uint64_t root, uint64_t* tw,
+                     size_t len, size_t tasks) {
+  size_t half = len / 2;
+  uint64_t w = f.pow(f.toMont(root), (f.mod - 1) / len);
+  size_t part = (half + tasks - 1) / tasks;
+  parallelFor(tasks, [&](size_t t) {
+    size_t from = std::min(half, t * part);
+    size_t to = std::min(half, from + part);
+    uint64_t cur = f.pow(w, from);
+    for (size_t j = from; j < to; j++, cur = f.mul(cur, w)) {
+      tw[half + j] = cur;
+    }
+  });
+  for (size_t h = half / 2; h >= 1; h /= 2) {
+    for (size_t j = 0; j < h; j++) {
+      tw[h + j] = tw[2 * h + 2 * j];
+    }
+  }
+}
+
+// Прореживание по частоте, результат в бит-реверсном порядке
+static void nttForward(ntt_field const& f, uint64_t* a, size_t len,
+                       uint64_t const* tw) {
+  for (size_t h = len / 2; h >= 1; h /= 2) {
+    uint64_t const* w = tw + h;
+    for (size_t s = 0; s < len; s += 2 * h) {
+      for (size_t j = 0; j < h; j++) {
+        uint64_t u = a[s + j];
+        uint64_t v = a[s + j + h];
+        a[s + j] = f.add(u, v);
+        a[s + j + h] = f.mul(f.sub(u, v), w[j]);
+      }
+    }
+  }
+}
+
+// Прореживание по времени из бит-реверсного порядка, без деления на len.
+// w^(-j) = -w^(h - j), поэтому хватает таблицы прямого преобразования
+static void nttInverse(ntt_field const& f, uint64_t* a, size_t len,
+                       uint64_t const* tw) {
+  for (size_t h = 1; h < len; h *= 2) {
+    uint64_t const* w = tw + h;
+    for (size_t s = 0; s < len; s += 2 * h) {
+      uint64_t u = a[s];
+      uint64_t v = a[s + h];
+      a[s] = f.add(u, v);
+      a[s + h] = f.sub(u, v);
+      for (size_t j = 1; j < h; j++) {
+        u = a[s + j];
+        v = f.mul(a[s + j + h], w[h - j]);
+        a[s + j] = f.sub(u, v);
+        a[s + j + h] = f.add(u, v);
+      }
+    }
+  }
+}
+
+// Преобразования длины len, разделённые на tasks равных задач (степень
+// двойки, не больше len / 2). Этапы с бабочками шире блока len / tasks
+// делятся по номерам бабочек, остальные -- по независимым блокам: таблица
+// tw не зависит от длины, поэтому блок преобразуется как целый массив
+static void nttForward(ntt_field const& f, uint64_t* a, size_t len,
+                       uint64_t const* tw, size_t tasks) {
+  size_t block = len / tasks;
+  for (size_t h = len / 2; h >= block; h /= 2) {
+    parallelFor(tasks, [&](size_t t) {
+      size_t q = t * (block / 2);
+      size_t s = q / h * 2 * h;
+      uint64_t const* w = tw + h;
+      for (size_t j = q % h; j < q % h + block / 2; j++) {
+        uint64_t u = a[s + j];
+        uint64_t v = a[s + j + h];
+        a[s + j] = f.add(u, v);
+        a[s + j + h] = f.mul(f.sub(u, v), w[j]);
+      }
+    });
+  }
+  parallelFor(tasks,
+              [&](size_t t) { nttForward(f, a + t * block, block, tw); });
+}
+
+static void nttInverse(ntt_field const& f, uint64_t* a, size_t len,
+                       uint64_t const* tw, size_t tasks) {
+  size_t block = len / tasks;
+  parallelFor(tasks,
+              [&](size_t t) { nttInverse(f, a + t * block, block, tw); });
+  for (size_t h = block; h < len; h *= 2) {
+    parallelFor(tasks, [&](size_t t) {
+      size_t q = t * (block / 2);
+      size_t s = q / h * 2 * h;
+      uint64_t const* w = tw + h;
+      for (size_t j = q % h; j < q % h + block / 2; j++) {
+        uint64_t u = a[s + j];
+        if (j == 0) {
+          uint64_t v = a[s + h];
+          a[s] = f.add(u, v);
+          a[s + h] = f.sub(u, v);
+        } else {
+          uint64_t v = f.mul(a[s + j + h], w[h - j]);
+          a[s + j] = f.sub(u, v);
+          a[s + j + h] = f.add(u, v);
+        }
+      }
+    });
+  }
+}
+
+// Разрядов в одной 64-битной цифре преобразования
+static const size_t NTT_DIGIT_LIMBS = 64 / BASE;
+
+// Разряды как 64-битные цифры по модулю f.mod, дополненные нулями до len,
+// цифры [from, to)
+static void nttLoad(ntt_field const& f, limb const* a, size_t n,
+                    uint64_t* out, size_t from, size_t to) {
+  for (size_t i = from; i < to; i++) {
+    uint64_t digit = 0;
+    for (size_t j = 0; j < NTT_DIGIT_LIMBS && i * NTT_DIGIT_LIMBS + j < n;
+         j++) {
+      digit |= static_cast<uint64_t>(a[i * NTT_DIGIT_LIMBS + j])
+               << (BASE * j);
+    }
+    out[i] = digit % f.mod;
+  }
+}
+
+// Цифры [from, to) свёртки по остаткам r[0], r[1], r[2] (китайская теорема
+// по Гарнеру) записываются на место r[0] без переноса из младших цифр.
+// Возвращает перенос в цифру to
+static uint128_t nttRecover(uint64_t* const* r, size_t from, size_t to) {
+  ntt_field f2(NTT_PRIMES[1]);
+  ntt_field f3(NTT_PRIMES[2]);
+  uint64_t p1 = NTT_PRIMES[0];
+  uint64_t p2 = NTT_PRIMES[1];
+  // Обратные к p1 по модулю p2 и к p1 * p2 по модулю p3 в форме Монтгомери
+  uint64_t inv1 = f2.pow(f2.toMont(p1), p2 - 2);
+  uint64_t p1m3 = f3.toMont(p1);
+  uint64_t inv12 = f3.pow(f3.mul(f3.toMont(p2), p1m3), f3.mod - 2);
+  uint128_t p12 = static_cast<uint128_t>(p1) * p2;
+  uint64_t p12lo = static_cast<uint64_t>(p12);
+  uint64_t p12hi = static_cast<uint64_t>(p12 >> 64);
+
+  uint64_t acc[2] = {0, 0};
+  for (size_t i = from; i < to; i++) {
+    // x = v1 + v2 * p1 + v3 * p1 * p2
+    uint64_t v1 = r[0][i];
+    uint64_t v2 = f2.mul(f2.sub(r[1][i], v1 % p2), inv1);
+    uint64_t v3 = f3.mul(f3.sub(f3.sub(r[2][i], v1 % f3.mod), f3.mul(v2, p1m3)),
+                         inv12);
+    uint128_t low = static_cast<uint128_t>(v2) * p1 + v1;
+    uint128_t midLo = static_cast<uint128_t>(v3) * p12lo;
+    uint128_t midHi = static_cast<uint128_t>(v3) * p12hi;
+
+    uint128_t s = static_cast<uint128_t>(acc[0]) +
+                          static_cast<uint64_t>(low) +
+                          static_cast<uint64_t>(midLo);
+    r[0][i] = static_cast<uint64_t>(s);
+    s = (s >> 64) + acc[1] + static_cast<uint64_t>(low >> 64) +
+        static_cast<uint64_t>(midLo >> 64) + static_cast<uint64_t>(midHi);
+    acc[0] = static_cast<uint64_t>(s);
+    acc[1] = static_cast<uint64_t>((s >> 64) + (midHi >> 64));
+  }
+  return (static_cast<uint128_t>(acc[1]) << 64) + acc[0];
+}
+
+// Умножение через теоретико-числовое преобразование по трём простым модулям.
+// При a == b преобразование делается одно. С пулом потоков длинные
+// множители делят каждый этап на задачи; свёртка собирается кусками
+// с независимыми переносами, которые затем добавляются по порядку
+static void mulNtt(limb const* a, size_t n, limb const* b, size_t m,
+                   limb* res) {
+  size_t digits = (n + NTT_DIGIT_LIMBS - 1) / NTT_DIGIT_LIMBS +
+                  (m + NTT_DIGIT_LIMBS - 1) / NTT_DIGIT_LIMBS;
+  size_t len = 1;
+  while (len < digits) {
+    len *= 2;
+  }
+  // Задач на этап: степень двойки, по четыре на поток, блоки не короче
+  // 2^12 цифр, чтобы синхронизация не была заметна
+  size_t tasks = 1;
+  if (std::min(n, m) >= PARALLEL_THRESHOLD) {
+    while (tasks < 4 * multiplication_threads() && (len >> 12) > tasks) {
+      tasks *= 2;
+    }
+  }
+  size_t part = len / tasks;
+  vector<uint64_t> buf;
+  buf.resize(5 * len, 0);
+  uint64_t* residues[3] = {buf.data(), buf.data() + len, buf.data() + 2 * len};
+  uint64_t* fb = buf.data() + 3 * len;
+  uint64_t* tw = buf.data() + 4 * len;
+  for (size_t k = 0; k < 3; k++) {
+    ntt_field f(NTT_PRIMES[k]);
+    uint64_t* fa = residues[k];
+    nttRoots(f, NTT_ROOTS[k], tw, len, tasks);
+    parallelFor(tasks, [&](size_t t) {
+      nttLoad(f, a, n, fa, t * part, (t + 1) * part);
+    });
+    nttForward(f, fa, len, tw, tasks);
+    if (a == b) {
+      std::copy(fa, fa + len, fb);
+    } else {
+      parallelFor(tasks, [&](size_t t) {
+        nttLoad(f, b, m, fb, t * part, (t + 1) * part);
+      });
+      nttForward(f, fb, len, tw, tasks);
+    }
+    // fa * fb * 2^(-64) после умножения, scale = 2^128 / len
+    uint64_t scale = f.mul(f.toMont(f.mod - (f.mod - 1) / len), f.r2);
+    parallelFor(tasks, [&](size_t t) {
+      for (size_t i = t * part; i < (t + 1) * part; i++) {
+        fa[i] = f.mul(f.mul(fa[i], fb[i]), scale);
+      }
+    });
+    nttInverse(f, fa, len, tw, tasks);
+  }
+  // Переносы кусков в fb, затем прибавляются к следующим кускам
+  size_t total = (n + m + NTT_DIGIT_LIMBS - 1) / NTT_DIGIT_LIMBS;
+  vector<uint128_t> carries;
+  carries.resize(tasks, 0);
+  parallelFor(tasks, [&](size_t t) {
+    carries[t] = nttRecover(residues, std::min(total, t * part),
+                            std::min(total, (t + 1) * part));
+  });
+  uint64_t* out = residues[0];
+  uint128_t carry = 0;
+  for (size_t t = 0; t < tasks; t++) {
+    size_t i = std::min(total, t * part);
+    for (; carry != 0 && i < std::min(total, (t + 1) * part); i++) {
+      carry += out[i];
+      out[i] = static_cast<uint64_t>(carry);
+      carry >>= 64;
+    }
+    carry += carries[t];
+  }
+  parallelFor(tasks, [&](size_t t) {
+    for (size_t i = t * part * NTT_DIGIT_LIMBS;
+         i < std::min(n + m, (t + 1) * part * NTT_DIGIT_LIMBS); i++) {
+      res[i] = static_cast<limb>(out[i / NTT_DIGIT_LIMBS] >>
+                                 (BASE * (i % NTT_DIGIT_LIMBS)));
+    }
+  });
+}
+
+// Алгоритм выбирается по длине меньшего множителя. Если a == b (тогда и
+// n == m), на каждом уровне используется вариант для возведения в квадрат
+static void mulRec(limb const* a, size_t n, limb const* b, size_t m,
+                   limb* res, limb* scratch) {
+  if (n < m) {
+    std::swap(a, b);
+    std::swap(n, m);
+  }
+  if (m < KARATSUBA_THRESHOLD) {
+    if (a == b && n == m) {
+      sqrSchool(a, n, res);
+    } else {
+      mulSchool(a, n, b, m, res);
+    }
+  } else if (m >= NTT_THRESHOLD) {
+    mulNtt(a, n, b, m, res);
+  } else if (2 * m <= n) {
+    mulUnbalanced(a, n, b, m, res);
+  } else if (m >= TOOM3_THRESHOLD && m > 2 * ((n + 2) / 3)) {
+    mulToom3(a, n, b, m, res);
+  } else {
+    mulKaratsuba(a, n, b, m, res, scratch);
+  }
+}
+
+// res[0, n + m) = a[0, n) * b[0, m) для неотрицательных a и b
+static void mulLimbs(limb const* a, size_t n, limb const* b, size_t m,
+                     limb* res) {
+  vector<limb> scratch;
+  scratch.resize(karatsubaScratch(std::max(n, m)), 0);
+  mulRec(a, n, b, m, res, scratch.data());
+}
+
+big_integer& big_integer::operator*=(big_integer const& rhs) {
+  int64_t a, b, small;
+  if (getSmall(a) && rhs.getSmall(b) && !__builtin_mul_overflow(a, b, &small)) {
+    setSmall(small);
+    return *this;
+  }
+  uint8_t resSign = sign ^ rhs.sign;
+  // a *= a и равные множители считаются как квадрат модуля *this
+  bool square = this == &rhs || (sign == rhs.sign && num == rhs.num);
+  // rhs может совпадать с *this, поэтому модуль rhs берём до изменения *this
+  big_integer negated;
+  big_integer const* sec = &rhs;
+  if (square) {
+    sec = this;
+  } else if (rhs.sign != 0) {
+    negated = -rhs;
+    sec = &negated;
+  }
+  if (sign != 0) {
+    negate();
+  }
+  size_t n = num.size();
+  while (n > 0 && num[n - 1] == 0) {
+    n--;
+  }
+  size_t m = sec->num.size();
+  while (m > 0 && sec->num[m - 1] == 0) {
+    m--;
+  }
+  big_integer res;
+  res.num.resize(n + m + 1, 0);
+  mulLimbs(num.data(), n, sec->num.data(), m, res.num.data());
+  res.fixLeadingBits();
+  if (resSign != 0) {
+    res.negate();
+  }
+  swap(res);
+  return *this;
+}
+
+big_integer& big_integer::addShort(limb rhs) {
+  addLimbsSigned(&rhs, 1, 0);
+  return *this;
+}
+
+big_integer& big_integer::subShort(limb rhs) {
+  subLimbsSigned(&rhs, 1, 0);
+  return *this;
+}
+
+limb big_integer::divRemShort(limb rhs) {
+  dlimb carry = 0;
+  for (int32_t i = num.size() - 1; i >= 0; i--) {
+    dlimb cur = num[i] + (carry << BASE);
+    num[i] = static_cast<limb>(cur / rhs);
+    carry = cur % rhs;
+  }
+  fixLeadingBits();
+  return static_cast<limb>(carry);
+}
+
+big_integer& big_integer::mulShort(limb rhs) {
+  dlimb carry = 0;
+  for (int32_t i = 0; i < num.size() || carry != 0; i++) {
+    if (i == num.size()) {
+      num.push_back(0);
+    }
+    dlimb cur = static_cast<dlimb>(num[i]) * rhs + carry;
+    num[i] = static_cast<limb>(cur);
+    carry = cur >> BASE;
+  }
+  fixLeadingBits();
+  return *this;
+}
+
+int32_t big_integer::normalize() {
+  limb first = num[magnitudeSize() - 1];
+  int32_t res = 0;
+  while (first < (limb(1) << (BASE - 1))) {
+    first <<= 1;
+    res++;
+  }
+  *this <<= res;
+  return res;
+}
+
+size_t big_integer::magnitudeSize() const {
+  size_t n = num.size();
+  while (n > 0 && num[n - 1] == 0) {
+    n--;
+  }
+  return n;
+}
+
+size_t big_integer::bitLength() const {
+  size_t n = magnitudeSize();
+  return n == 0 ? 0 : n * BASE - leadingZeros(num[n - 1]);
+}
+
+big_integer big_integer::limbRange(size_t from, size_t to) const {
+  to = std::min(to, num.size());
+  from = std::min(from, to);
+  big_integer res;
+  res.num.resize(to - from + 1, 0);
+  std::copy(num.data() + from, num.data() + to, res.num.data());
+  res.fixLeadingBits();
+  return res;
+}
+
+big_integer big_integer::divRemSchool(big_integer const& b) {
+  size_t n = magnitudeSize();
+  size_t m = b.magnitudeSize();
+  big_integer res;
+  if (n < m) {
+    return res;
+  }
+  if (m == 1) {
+    limb rem = divRemShort(b.num[0]);
+    swap(res);
+    num.clear();
+    pushBits(rem);
+    return res;
+  }
+  // Делимое и делитель, сдвинутые до старшего бита 1 в делителе, лежат
+  // в одном буфере на всё деление
+  uint32_t shift = leadingZeros(b.num[m - 1]);
+  vector<limb> scratch;
+  scratch.resize(n + 1 + m, 0);
+  limb* a = scratch.data();
+  limb* d = a + n + 1;
+  a[n] = shlLimbs(num.data(), n, shift, a);
+  shlLimbs(b.num.data(), m, shift, d);
+  res.num.resize(n - m + 2, 0);
+  divSchool(a, n - m + 1, d, m, res.num.data());
+  res.fixLeadingBits();
+  shrLimbs(a, m, shift);
+  num.resize(m + 1, 0);
+  std::copy(a, a + m, num.data());
+  num[m] = 0;
+  fixLeadingBits();
+  return res;
+}
+
+// Поправки к оценкам деления через обратное: при самых малых порогах их
+// бывает до 8 у обратного и одна у цифры частного. Больше -- ошибка в
+// оценке, и вместо долгого цикла бросается std::logic_error
+static const int RECIPROCAL_MAX_CORRECTIONS = 32;
+static const int NEWTON_DIGIT_MAX_CORRECTIONS = 4;
+
+static void countCorrection(int& count, int limit) {
+  if (++count > limit) {
+    throw std::logic_error("Newton division estimate is off");
+  }
+}
+
+big_integer big_integer::reciprocal(big_integer const& b, size_t n) {
+  big_integer power = big_integer(1) << (2 * n * BASE);
+  if (n < 2 * BZ_DIVISION_THRESHOLD) {
+    return n < BZ_DIVISION_THRESHOLD ? power.divRemSchool(b)
+                                     : power.divRemBurnikelZiegler(b);
+  }
+  // Обратное к старшей половине b даёт половину верных разрядов,
+  // шаг Ньютона x += x * (B^(2n) - b * x) / B^(2n) удваивает их число.
+  // x = r * B^(n - h), поэтому умножается только r из h + 1 разрядов
+  size_t h = (n + 1) / 2;
+  big_integer r = reciprocal(b.limbRange(n - h, n), h);
+  big_integer e = power - ((b * r) << ((n - h) * BASE));
+  // Младшие n - 2 разряда e меняют поправку меньше чем на 1 / B
+  big_integer delta = (r * (e >> ((n - 2) * BASE))) >> ((h + 2) * BASE);
+  big_integer x = (r << ((n - h) * BASE)) + delta;
+  e -= b * delta;
+  // Ошибка после шага -- несколько единиц, доводим до точного значения
+  int corrections = 0;
+  while (e < 0) {
+    countCorrection(corrections, RECIPROCAL_MAX_CORRECTIONS);
+    x--;
+    e += b;
+  }
+  while (e >= b) {
+    countCorrection(corrections, RECIPROCAL_MAX_CORRECTIONS);
+    x++;
+    e -= b;
+  }
+  return x;
+}
+
+template <typename F>
+big_integer big_integer::divRemByBlocks(size_t n, F divDigit) {
+  size_t len = magnitudeSize();
+  size_t blocks = (len + n - 1) / n;
+  big_integer res;
+  res.num.resize(blocks * n + 1, 0);
+  big_integer rem;
+  for (size_t i = blocks; i-- > 0;) {
+    big_integer cur = (rem << (n * BASE)) + limbRange(i * n, (i + 1) * n);
+    big_integer digit = divDigit(cur);
+    std::copy(digit.num.data(), digit.num.data() + digit.magnitudeSize(),
+              res.num.data() + i * n);
+    rem.swap(cur);
+  }
+  res.fixLeadingBits();
+  swap(rem);
+  return res;
+}
+
+big_integer big_integer::divRemNewton(big_integer b) {
+  size_t n = b.magnitudeSize();
+  int32_t shift = b.normalize();
+  *this <<= shift;
+  big_integer inv = reciprocal(b, n);
+  // Каждая цифра частного по основанию B^n получается двумя умножениями
+  big_integer res = divRemByBlocks(n, [&](big_integer& cur) {
+    big_integer digit =
+        ((cur >> ((n - 1) * BASE)) * inv) >> ((n + 1) * BASE);
+    cur -= digit * b;
+    // digit не больше верной цифры и отличается от неё не более чем на 2
+    int corrections = 0;
+    while (cur >= b) {
+      countCorrection(corrections, NEWTON_DIGIT_MAX_CORRECTIONS);
+      digit++;
+      cur -= b;
+    }
+    return digit;
+  });
+  *this >>= shift;
+  return res;
+}
+
+big_integer big_integer::divTwoByOne(big_integer const& b, size_t n) {
+  if (n % 2 != 0 || n < BZ_DIVISION_THRESHOLD) {
+    return *this < b ? big_integer() : divRemSchool(b);
+  }
+  size_t h = n / 2;
+  big_integer low = limbRange(0, h);
+  *this >>= h * BASE;
+  big_integer high = divThreeByTwo(b, n);
+  *this <<= h * BASE;
+  *this += low;
+  big_integer res = divThreeByTwo(b, n);
+  return res + (high << (h * BASE));
+}
+
+big_integer big_integer::divThreeByTwo(big_integer const& b, size_t n) {
+  size_t h = n / 2;
+  big_integer b1 = b.limbRange(h, n);
+  big_integer a3 = limbRange(0, h);
+  *this >>= h * BASE;
+  big_integer res;
+  if ((*this >> (h * BASE)) < b1) {
+    res = divTwoByOne(b1, h);
+  } else {
+    // Частное не меньше B^h - 1, а оценка сверху не больше него
+    res = (big_integer(1) << (h * BASE)) - 1;
+    *this -= b1 << (h * BASE);
+    *this += b1;
+  }
+  *this <<= h * BASE;
+  *this += a3;
+  *this -= res * b.limbRange(0, h);
+  // Оценка частного завышена не более чем на 2
+  while (sign != 0) {
+    res--;
+    *this += b;
+  }
+  return res;
+}
+
+big_integer big_integer::divRemBurnikelZiegler(big_integer b) {
+  // Длина делителя дополняется нулевыми разрядами до j * 2^k, j меньше
+  // порога, чтобы рекурсия делила пополам до деления в столбик
+  size_t n = b.magnitudeSize();
+  size_t k = 0;
+  while ((n >> k) >= BZ_DIVISION_THRESHOLD) {
+    k++;
+  }
+  size_t padded = ((n + (1ull << k) - 1) >> k) << k;
+  int32_t shift = (padded - n) * BASE;
+  b <<= shift;
+  int32_t bits = b.normalize();
+  shift += bits;
+  *this <<= shift;
+  big_integer res = divRemByBlocks(
+      padded, [&](big_integer& cur) { return cur.divTwoByOne(b, padded); });
+  *this >>= shift;
+  return res;
+}
+
+big_integer big_integer::divRemMagnitude(big_integer const& b) {
+  if (*this < b) {
+    return big_integer();
+  }
+  size_t n = b.magnitudeSize();
+  return n < BZ_DIVISION_THRESHOLD       ? divRemSchool(b)
+         : n < NEWTON_DIVISION_THRESHOLD ? divRemBurnikelZiegler(b)
+                                         : divRemNewton(b);
+}
+
+void big_integer::divRem(big_integer const& rhs, big_integer& quot) {
+  int64_t small, divisor;
+  if (getSmall(small) && rhs.getSmall(divisor) && divisor != 0 &&
+      !(small == std::numeric_limits<int64_t>::min() && divisor == -1)) {
+    quot.setSmall(small / divisor);
+    setSmall(small % divisor);
+    return;
+  }
+  if (rhs == 0) {
+    throw std::invalid_argument("Division by zero");
+  }
+  bool negative = sign != 0;
+  uint8_t resSign = 0;
+  big_integer b = rhs;
+  if (negative) {
+    negate();
+    resSign ^= 1;
+  }
+  if (b < 0) {
+    b.negate();
+    resSign ^= 1;
+  }
+  if (*this < b) {
+    quot.setSmall(0);
+  } else {
+    quot = divRemMagnitude(b);
+    if (resSign != 0) {
+      quot.negate();
+    }
+    quot.fixLeadingBits();
+  }
+  if (negative) {
+    negate();
+  }
+}
+
+big_integer& big_integer::divRemLong(const big_integer& rhs, bool remNeeded) {
+  big_integer quot;
+  divRem(rhs, quot);
+  if (!remNeeded) {
+    swap(quot);
+  }
+  return *this;
+}
+
+big_integer& big_integer::operator/=(big_integer const& rhs) {
+  return divRemLong(rhs, false);
+}
+
+big_integer& big_integer::operator%=(big_integer const& rhs) {
+  return divRemLong(rhs, true);
+}
+
+// Поразрядные операции для встроенных целых, разрядов и векторов разрядов
+struct bit_and {
+  template <typename T>
+  static T apply(T a, T b) {
+    return a & b;
+  }
+#if BIGINT_SIMD
+  BIGINT_TARGET_SSE2 static __m128i apply(__m128i a, __m128i b) {
+    return _mm_and_si128(a, b);
+  }
+  BIGINT_TARGET_AVX2 static __m256i apply(__m256i a, __m256i b) {
+    return _mm256_and_si256(a, b);
+  }
+#endif
+};
+
+struct bit_or {
+  template <typename T>
+  static T apply(T a, T b) {
+    return a | b;
+  }
+#if BIGINT_SIMD
+  BIGINT_TARGET_SSE2 static __m128i apply(__m128i a, __m128i b) {
+    return _mm_or_si128(a, b);
+  }
+  BIGINT_TARGET_AVX2 static __m256i apply(__m256i a, __m256i b) {
+    return _mm256_or_si256(a, b);
+  }
+#endif
+};
+
+struct bit_xor {
+  template <typename T>
+  static T apply(T a, T b) {
+    return a ^ b;
+  }
+#if BIGINT_SIMD
+  BIGINT_TARGET_SSE2 static __m128i apply(__m128i a, __m128i b) {
+    return _mm_xor_si128(a, b);
+  }
+  BIGINT_TARGET_AVX2 static __m256i apply(__m256i a, __m256i b) {
+    return _mm256_xor_si256(a, b);
+  }
+#endif
+};
+
+// a & ~b
+struct bit_and_not {
+  template <typename T>
+  static T apply(T a, T b) {
+    return a & ~b;
+  }
+#if BIGINT_SIMD
+  BIGINT_TARGET_SSE2 static __m128i apply(__m128i a, __m128i b) {
+    return _mm_andnot_si128(b, a);
+  }
+  BIGINT_TARGET_AVX2 static __m256i apply(__m256i a, __m256i b) {
+    return _mm256_andnot_si256(b, a);
+  }
+#endif
+};
+
+// ~a, второй операнд не используется
+struct bit_not {
+  template <typename T>
+  static T apply(T a, T) {
+    return ~a;
+  }
+#if BIGINT_SIMD
+  BIGINT_TARGET_SSE2 static __m128i apply(__m128i a, __m128i) {
+    return _mm_xor_si128(a, _mm_set1_epi32(-1));
+  }
+  BIGINT_TARGET_AVX2 static __m256i apply(__m256i a, __m256i) {
+    return _mm256_xor_si256(a, _mm256_set1_epi32(-1));
+  }
+#endif
+};
+
+#if BIGINT_SIMD
+// 0 -- без векторных команд, 1 -- SSE2, 2 -- AVX2
+static int simdLevel() {
+  static const int level = [] {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      return 2;
+    }
+    return __builtin_cpu_supports("sse2") ? 1 : 0;
+  }();
+  return level;
+}
+
+// Невыровненные загрузки: буфер числа выровнен только по разряду
+template <typename Op>
+BIGINT_TARGET_SSE2 static size_t bitLoopSse2(limb* a, limb const* b,
+                                             size_t n) {
+  size_t i = 0;
+  for (; i + 16 / sizeof(limb) <= n; i += 16 / sizeof(limb)) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i));
+    __m128i y = _mm_loadu_si128(reinterpret_cast<__m128i const*>(b + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(a + i), Op::apply(x, y));
+  }
+  return i;
+}
+
+// По два вектора за шаг, чтобы загрузки шли впереди записей
+template <typename Op>
+BIGINT_TARGET_AVX2 static size_t bitLoopAvx2(limb* a, limb const* b,
+                                             size_t n) {
+  size_t const step = 32 / sizeof(limb);
+  size_t i = 0;
+  for (; i + 2 * step <= n; i += 2 * step) {
+    __m256i x0 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+    __m256i x1 =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i + step));
+    __m256i y0 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+    __m256i y1 =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i + step));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(a + i),
+                        Op::apply(x0, y0));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(a + i + step),
+                        Op::apply(x1, y1));
+  }
+  if (i + step <= n) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+    __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(a + i), Op::apply(x, y));
+    i += step;
+  }
+  return i;
+}
+#endif
+
+// a[0, n) = a op b[0, n); b может совпадать с a
+template <typename Op>
+static void bitLoop(limb* a, limb const* b, size_t n) {
+  size_t i = 0;
+#if BIGINT_SIMD
+  int level = simdLevel();
+  if (level == 2) {
+    i = bitLoopAvx2<Op>(a, b, n);
+  } else if (level == 1) {
+    i = bitLoopSse2<Op>(a, b, n);
+  }
+#endif
+  for (; i < n; i++) {
+    a[i] = Op::apply(a[i], b[i]);
+  }
+}
+
+template <typename Op>
+void big_integer::makeBinaryBitOp(const big_integer& rhs, Op op) {
+  int64_t a, b;
+  if (getSmall(a) && rhs.getSmall(b)) {
+    setSmall(op.apply(a, b));
+    return;
+  }
+  // Общие разряды обрабатываются на месте, так что rhs может совпадать
+  // с этим числом
+  makeBinaryBitOp(rhs.num.data(), rhs.num.size(), rhs.signBits(), op);
+}
+
+template <typename Op>
+void big_integer::makeBinaryBitOp(native_int rhs, Op op) {
+  int64_t a;
+  if (getSmall(a) && nativeFits(rhs.bits, rhs.negative)) {
+    setSmall(op.apply(a, static_cast<int64_t>(rhs.bits)));
+    return;
+  }
+  limb b[SMALL_LIMBS];
+  limb fill = nativeLimbs(rhs, b);
+  makeBinaryBitOp(b, SMALL_LIMBS, fill, op);
+}
+
+template <typename Op>
+void big_integer::makeBinaryBitOp(limb const* b, size_t m, limb fill,
+                                  Op op) {
+  size_t n = num.size();
+  if (n < m) {
+    setLen(m);
+  }
+  bitLoop<Op>(num.data(), b, m);
+  // За разрядами b -- его знак fill: с ним операция оставляет разряды
+  // как есть, заполняет одним значением или инвертирует
+  limb zero = op.apply(limb(0), fill);
+  limb ones = op.apply(~limb(0), fill);
+  if (m < n && zero == ones) {
+    std::fill(num.data() + m, num.data() + n, zero);
+  } else if (m < n && zero != 0) {
+    bitLoop<bit_not>(num.data() + m, num.data() + m, n - m);
+  }
+  sign = op.apply(sign, static_cast<uint8_t>(fill & 1)) & 1;
+  fixLeadingBits();
+}
+
+big_integer& big_integer::operator&=(big_integer const& rhs) {
+  makeBinaryBitOp(rhs, bit_and());
+  return *this;
+}
+
+big_integer& big_integer::operator|=(big_integer const& rhs) {
+  makeBinaryBitOp(rhs, bit_or());
+  return *this;
+}
+
+big_integer& big_integer::operator^=(big_integer const& rhs) {
+  makeBinaryBitOp(rhs, bit_xor());
+  return *this;
+}
+
+big_integer& big_integer::andNative(native_int rhs) {
+  makeBinaryBitOp(rhs, bit_and());
+  return *this;
+}
+
+big_integer& big_integer::orNative(native_int rhs) {
+  makeBinaryBitOp(rhs, bit_or());
+  return *this;
+}
+
+big_integer& big_integer::xorNative(native_int rhs) {
+  makeBinaryBitOp(rhs, bit_xor());
+  return *this;
+}
+
+big_integer and_not(big_integer const& a, big_integer const& b) {
+  big_integer res = a;
+  res.makeBinaryBitOp(b, bit_and_not());
+  return res;
+}
+
+big_integer& big_integer::operator<<=(int rhs) {
+  int64_t a;
+  if (getSmall(a) && rhs < 64 && (a == 0 || __builtin_clrsbll(a) >= rhs)) {
+    setSmall(static_cast<int64_t>(static_cast<uint64_t>(a) << rhs));
+    return *this;
+  }
+  setLen(num.size() + (rhs + BASE - 1) / BASE);
+  int32_t mod = rhs % BASE;
+  if (mod != 0) {
+    limb carry = 0;
+    for (limb& i : num) {
+      limb temp = i >> (BASE - mod);
+      i = (i << mod) + carry;
+      carry = temp;
+    }
+  }
+  for (int32_t i = num.size() - 1; i >= (int32_t)(rhs / BASE); i--) {
+    num[i] = num[i - rhs / BASE];
+  }
+  for (int32_t i = rhs / BASE - 1; i >= 0; i--) {
+    num[i] = 0;
+  }
+  fixLeadingBits();
+  return *this;
+}
+
+big_integer& big_integer::operator>>=(int rhs) {
+  int64_t a;
+  if (getSmall(a)) {
+    setSmall(a >> std::min(rhs, 63));
+    return *this;
+  }
+  setLen(num.size() + (rhs + BASE - 1) / BASE);
+  limb carry = 0;
+  int mod = rhs % BASE;
+  if (mod != 0) {
+    for (int32_t i = num.size() - 1; i >= 0; i--) {
+      limb temp = num[i] & ((limb(1) << mod) - 1);
+      num[i] = (num[i] >> mod) + (carry << (BASE - mod));
+      carry = temp;
+    }
+  }
+  for (size_t i = 0; i < num.size() - (rhs + BASE - 1) / BASE; i++) {
+    num[i] = num[i + rhs / BASE];
+  }
+  for (size_t i = 0; i < (rhs + BASE - 1) / BASE; i++) {
+    num.pop_back();
+  }
+  fixLeadingBits();
+  return *this;
+}
+
+big_integer big_integer::operator+() const {
+  return *this;
+}
+
+void big_integer::invert() {
+  sign ^= 1;
+  bitLoop<bit_not>(num.data(), num.data(), num.size());
+  fixLeadingBits();
+}
+
+void big_integer::negate() {
+  int64_t a;
+  if (getSmall(a) && a != std::numeric_limits<int64_t>::min()) {
+    setSmall(-a);
+    return;
+  }
+  if (*this != 0) {
+    invert();
+    addShort(1);
+  }
+}
+
+big_integer big_integer::operator-() const {
+  big_integer res(*this);
+  res.negate();
+  res.fixLeadingBits();
+  return res;
+}
+
+big_integer big_integer::operator~() const {
+  big_integer res = *this;
+  res.invert();
+  return res;
+}
+
+big_integer& big_integer::operator++() {
+  int64_t a;
+  if (getSmall(a) && a != std::numeric_limits<int64_t>::max()) {
+    setSmall(a + 1);
+    return *this;
+  }
+  addShort(1);
+  return *this;
+}
+
+big_integer big_integer::operator++(int) {
+  big_integer res = *this;
+  ++*this;
+  return res;
+}
+
+big_integer& big_integer::operator--() {
+  int64_t a;
+  if (getSmall(a) && a != std::numeric_limits<int64_t>::min()) {
+    setSmall(a - 1);
+    return *this;
+  }
+  subShort(1);
+  return *this;
+}
+
+big_integer big_integer::operator--(int) {
+  big_integer res = *this;
+  --*this;
+  return res;
+}
+
+big_integer operator+(big_integer a, big_integer const& b) {
+  a += b;
+  return a;
+}
+
+big_integer operator-(big_integer a, big_integer const& b) {
+  a -= b;
+  return a;
+}
+
+big_integer operator*(big_integer a, big_integer const& b) {
+  a *= b;
+  return a;
+}
+
+big_integer operator/(big_integer a, big_integer const& b) {
+  a /= b;
+  return a;
+}
+
+big_integer operator%(big_integer a, big_integer const& b) {
+  a %= b;
+  return a;
+}
+
+big_integer operator&(big_integer a, big_integer const& b) {
+  a &= b;
+  return a;
+}
+
+big_integer operator|(big_integer a, big_integer const& b) {
+  return a |= b;
+}
+
+big_integer operator^(big_integer a, big_integer const& b) {
+  a ^= b;
+  return a;
+}
+
+big_integer operator+(big_integer const& a, big_integer&& b) {
+  b += a;
+  return std::move(b);
+}
+
+big_integer operator-(big_integer const& a, big_integer&& b) {
+  b -= a;
+  b.negate();
+  return std::move(b);
+}
+
+big_integer operator&(big_integer const& a, big_integer&& b) {
+  b &= a;
+  return std::move(b);
+}
+
+big_integer operator|(big_integer const& a, big_integer&& b) {
+  b |= a;
+  return std::move(b);
+}
+
+big_integer operator^(big_integer const& a, big_integer&& b) {
+  b ^= a;
+  return std::move(b);
+}
+
+big_integer operator+(big_integer&& a, big_integer&& b) {
+  if (a.num.capacity() >= b.num.capacity()) {
+    a += b;
+    return std::move(a);
+  }
+  b += a;
+  return std::move(b);
+}
+
+big_integer operator-(big_integer&& a, big_integer&& b) {
+  if (a.num.capacity() >= b.num.capacity()) {
+    a -= b;
+    return std::move(a);
+  }
+  return a - std::move(b);
+}
+
+big_integer operator&(big_integer&& a, big_integer&& b) {
+  if (a.num.capacity() >= b.num.capacity()) {
+    a &= b;
+    return std::move(a);
+  }
+  return a & std::move(b);
+}
+
+big_integer operator|(big_integer&& a, big_integer&& b) {
+  if (a.num.capacity() >= b.num.capacity()) {
+    a |= b;
+    return std::move(a);
+  }
+  return a | std::move(b);
+}
+
+big_integer operator^(big_integer&& a, big_integer&& b) {
+  if (a.num.capacity() >= b.num.capacity()) {
+    a ^= b;
+    return std::move(a);
+  }
+  return a ^ std::move(b);
+}
+
+big_integer operator<<(big_integer a, int b) {
+  return a <<= b;
+}
+
+big_integer operator>>(big_integer a, int b) {
+  return a >>= b;
+}
+
+int32_t big_integer::compareTo(const big_integer& a) const {
+  int64_t x, y;
+  if (getSmall(x) && a.getSmall(y)) {
+    return x < y ? -1 : x > y ? 1 : 0;
+  }
+  return compareLimbs(a.num.data(), a.num.size(), a.signBits());
+}
+
+int32_t big_integer::compareNative(native_int rhs) const {
+  int64_t x;
+  if (getSmall(x) && nativeFits(rhs.bits, rhs.negative)) {
+    int64_t y = static_cast<int64_t>(rhs.bits);
+    return x < y ? -1 : x > y ? 1 : 0;
+  }
+  limb b[SMALL_LIMBS];
+  limb fill = nativeLimbs(rhs, b);
+  return compareLimbs(b, SMALL_LIMBS, fill);
+}
+
+int32_t big_integer::compareLimbs(limb const* b, size_t m, limb fill) const {
+  uint8_t bSign = fill == 0 ? 0 : 1;
+  if (sign == 0 && bSign != 0) {
+    return 1;
+  }
+  if (sign != 0 && bSign == 0) {
+    return -1;
+  }
+  for (int32_t i = std::max(m, num.size()) - 1; i >= 0; i--) {
+    limb cur = (i < num.size() ? num[i] : signBits());
+    limb other = (i < m ? b[i] : fill);
+    if (cur > other) {
+      return 1;
+    } else if (cur < other) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+bool operator==(big_integer const& a, big_integer const& b) {
+  return a.compareTo(b) == 0;
+}
+
+bool operator!=(big_integer const& a, big_integer const& b) {
+  return a.compareTo(b) != 0;
+}
+
+bool operator<(big_integer const& a, big_integer const& b) {
+  return a.compareTo(b) < 0;
+}
+
+bool operator>(big_integer const& a, big_integer const& b) {
+  return a.compareTo(b) > 0;
+}
+
+bool operator<=(big_integer const& a, big_integer const& b) {
+  return a.compareTo(b) <= 0;
+}
+
+bool operator>=(big_integer const& a, big_integer const& b) {
+  return a.compareTo(b) >= 0;
+}
+
+big_integer const& big_integer::radixPower(radix const& r, size_t k) {
+  // Элементы deque не перемещаются при добавлении, поэтому ссылки на уже
+  // посчитанные степени остаются верными для всех потоков
+  static std::mutex mutex;
+  static std::deque<big_integer> cache[37];
+  std::lock_guard<std::mutex> lock(mutex);
+  std::deque<big_integer>& powers = cache[r.base];
+  if (powers.empty()) {
+    powers.push_back(r.power);
+  }
+  while (powers.size() <= k) {
+    powers.push_back(powers.back() * powers.back());
+  }
+  return powers[k];
+}
+
+char* big_integer::writeDigits(radix const& r,
+                               vector<big_integer const*> const& powers,
+                               size_t k, char* out, bool pad) {
+  if (num.size() <= TO_STRING_THRESHOLD) {
+    // Без дополнения цифры пишутся слева направо с младших и потом
+    // разворачиваются, в последней группе -- только до старшей ненулевой
+    size_t width = pad ? r.digits << (k + 1) : 0;
+    char* pos = pad ? out + width : out;
+    do {
+      limb rem = divRemShort(r.power);
+      size_t count = r.digits;
+      if (!pad && *this == 0) {
+        count = 1;
+        for (limb rest = rem / r.base; rest != 0; rest /= r.base) {
+          count++;
+        }
+      }
+      if (r.base == 10) {
+        // Деление на константу компилятор заменяет умножением
+        for (size_t i = 0; i < count; i++, rem /= 10) {
+          *(pad ? --pos : pos++) = static_cast<char>('0' + rem % 10);
+        }
+      } else {
+        for (size_t i = 0; i < count; i++, rem /= r.base) {
+          *(pad ? --pos : pos++) = DIGIT_CHARS[rem % r.base];
+        }
+      }
+    } while (*this != 0);
+    if (pad) {
+      std::fill(out, pos, '0');
+      return out + width;
+    }
+    std::reverse(out, pos);
+    return pos;
+  }
+  if (!pad && *this < *powers[k]) {
+    return writeDigits(r, powers, k - 1, out, false);
+  }
+  big_integer high = divRemMagnitude(*powers[k]);
+  out = high.writeDigits(r, powers, k - 1, out, pad);
+  return writeDigits(r, powers, k - 1, out, true);
+}
+
+void big_integer::writeBits(uint32_t bits, char* out, size_t count) const {
+  size_t n = num.size();
+  limb mask = (static_cast<limb>(1) << bits) - 1;
+  // Модуль отрицательного числа ~a + 1 считается по ходу чтения разрядов
+  limb flip = signBits();
+  limb carry = sign;
+  dlimb acc = 0;
+  uint32_t have = 0;
+  size_t i = 0;
+  for (char* pos = out + count; pos != out;) {
+    if (have < bits) {
+      limb cur = 0;
+      if (i < n) {
+        cur = (num[i++] ^ flip) + carry;
+        carry = cur == 0 ? carry : 0;
+      }
+      acc |= static_cast<dlimb>(cur) << have;
+      have += BASE;
+    }
+    *--pos = DIGIT_CHARS[static_cast<limb>(acc) & mask];
+    acc >>= bits;
+    have -= bits;
+  }
+}
+
+big_integer big_integer::readBits(char const* digits, size_t len,
+                                  uint32_t bits) {
+  big_integer res;
+  res.num.resize(len * bits / BASE + 2, 0);
+  limb cur = 0;
+  uint32_t have = 0;
+  size_t used = 0;
+  for (size_t i = len; i-- > 0;) {
+    limb digit = digitValue(digits[i]);
+    cur |= digit << have;
+    have += bits;
+    if (have >= BASE) {
+      // Цифра, не поместившаяся в разряд, начинает следующий
+      res.num[used++] = cur;
+      have -= BASE;
+      cur = have == 0 ? 0 : digit >> (bits - have);
+    }
+  }
+  res.num[used] = cur;
+  res.fixLeadingBits();
+  return res;
+}
+
+big_integer::big_integer(std::string const& str) : big_integer(str, 10) {}
+
+big_integer::big_integer(std::string const& str, uint32_t base) : sign(0) {
+  radix r = makeRadix(base);
+  if (str.size() == 0 || (str[0] == '-' && str.size() == 1)) {
+    throw std::invalid_argument("Got empty string in number constructor");
+  }
+  size_t first = str[0] == '-' ? 1 : 0;
+  for (size_t i = first; i < str.size(); i++) {
+    if (digitValue(str[i]) >= base) {
+      throw std::invalid_argument("Wrong number format");
+    }
+  }
+  readAny(r, str.data() + first, str.size() - first).swap(*this);
+  if (str[0] == '-') {
+    negate();
+  }
+}
+
+big_integer big_integer::readAny(radix const& r, char const* digits,
+                                 size_t len) {
+  if (r.bits != 0) {
+    return readBits(digits, len, r.bits);
+  }
+  // *powers[k] = b^(d * 2^k), последняя степень короче записи числа
+  vector<big_integer const*> powers;
+  if (len > r.digits * FROM_STRING_THRESHOLD) {
+    powers.push_back(&radixPower(r, 0));
+    while ((r.digits << powers.size()) < len) {
+      powers.push_back(&radixPower(r, powers.size()));
+    }
+  }
+  return readDigits(r, digits, len, powers);
+}
+
+big_integer big_integer::readDigits(radix const& r, char const* digits,
+                                    size_t len,
+                                    vector<big_integer const*> const& powers) {
+  if (len <= r.digits * FROM_STRING_THRESHOLD) {
+    // d цифр помещаются в разряд, поэтому разрядов хватит с запасом под
+    // знак
+    big_integer res;
+    res.num.resize(len / r.digits + 2, 0);
+    size_t used = 0;
+    for (size_t i = 0; i < len;) {
+      size_t step = std::min(len - i, r.digits);
+      limb cur = 0;
+      limb factor = 1;
+      for (size_t j = 0; j < step; j++, i++, factor *= r.base) {
+        cur = cur * r.base + digitValue(digits[i]);
+      }
+      limb carry = mulAddShort(res.num.data(), used, factor, cur);
+      if (carry != 0) {
+        res.num[used++] = carry;
+      }
+    }
+    res.fixLeadingBits();
+    return res;
+  }
+  size_t k = powers.size() - 1;
+  while ((r.digits << k) >= len) {
+    k--;
+  }
+  size_t low = r.digits << k;
+  big_integer res = readDigits(r, digits, len - low, powers);
+  res *= *powers[k];
+  res += readDigits(r, digits + len - low, low, powers);
+  return res;
+}
+
+big_integer::limb_view big_integer::limbs() const {
+  return {num.data(), num.size()};
+}
+
+size_t big_integer::payloadBytes() const {
+  size_t n = num.size();
+  while (n > 0 && num[n - 1] == signBits()) {
+    n--;
+  }
+  if (n == 0) {
+    return 0;
+  }
+  size_t topBits = BASE - leadingZeros(num[n - 1] ^ signBits());
+  return (n - 1) * sizeof(limb) + (topBits + 7) / 8;
+}
+
+size_t big_integer::encoded_size() const {
+  return ENCODED_HEADER + payloadBytes();
+}
+
+size_t big_integer::encode(unsigned char* out) const {
+  uint64_t bytes = payloadBytes();
+  for (size_t i = 0; i < 8; i++) {
+    out[i] = static_cast<unsigned char>(bytes >> (8 * i));
+  }
+  out[8] = sign;
+  if (LITTLE_ENDIAN_LIMBS) {
+    std::memcpy(out + ENCODED_HEADER, num.data(), bytes);
+  } else {
+    for (size_t i = 0; i < bytes; i++) {
+      out[ENCODED_HEADER + i] = static_cast<unsigned char>(
+          num[i / sizeof(limb)] >> (8 * (i % sizeof(limb))));
+    }
+  }
+  return ENCODED_HEADER + bytes;
+}
+
+size_t big_integer::decode(unsigned char const* in, size_t size) {
+  if (size < ENCODED_HEADER) {
+    throw std::invalid_argument("Truncated binary number");
+  }
+  uint64_t bytes = 0;
+  for (size_t i = 0; i < 8; i++) {
+    bytes |= static_cast<uint64_t>(in[i]) << (8 * i);
+  }
+  if (in[8] > 1) {
+    throw std::invalid_argument("Wrong binary number format");
+  }
+  if (bytes > size - ENCODED_HEADER) {
+    throw std::invalid_argument("Truncated binary number");
+  }
+  // Буфер числа переиспользуется: после reserve ничего не бросает.
+  // Байты записи покрывают все разряды, кроме последнего, а он заполнен
+  // знаком и дополняется до его расширения
+  size_t n = bytes / sizeof(limb) + 1;
+  num.reserve(n);
+  sign = in[8];
+  num.resize(n, 0);
+  num[n - 1] = signBits();
+  if (LITTLE_ENDIAN_LIMBS) {
+    std::memcpy(num.data(), in + ENCODED_HEADER, bytes);
+  } else {
+    for (size_t i = 0; i < bytes; i++) {
+      size_t shift = 8 * (i % sizeof(limb));
+      limb& cur = num[i / sizeof(limb)];
+      cur &= ~(static_cast<limb>(0xff) << shift);
+      cur |= static_cast<limb>(in[ENCODED_HEADER + i]) << shift;
+    }
+  }
+  fixLeadingBits();
+  return ENCODED_HEADER + bytes;
+}
+
+// Перемешивание слова и итоговое перемешивание хеша, как в MurmurHash3
+static uint64_t hashWord(uint64_t h, uint64_t w) {
+  w *= 0x87c37b91114253d5ull;
+  w = (w << 31) | (w >> 33);
+  w *= 0x4cf5ad432745937full;
+  h ^= w;
+  h = (h << 27) | (h >> 37);
+  return h * 5 + 0x52dce729;
+}
+
+static uint64_t hashFinish(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  return h;
+}
+
+size_t big_integer::hash() const noexcept {
+  // Старшие разряды, совпадающие со знаком, не входят в хеш
+  size_t n = num.size();
+  while (n > 0 && num[n - 1] == signBits()) {
+    n--;
+  }
+  uint64_t h = sign;
+  size_t i = 0;
+  for (; i + 64 / BASE <= n; i += 64 / BASE) {
+    uint64_t w = num[i];
+    if (BASE == 32) {
+      w |= static_cast<uint64_t>(num[i + 1]) << 32;
+    }
+    h = hashWord(h, w);
+  }
+  if (i < n) {
+    h = hashWord(h, num[i]);
+  }
+  return static_cast<size_t>(hashFinish(h ^ n));
+}
+
+hashed_big_integer::hashed_big_integer(big_integer value)
+    : val(std::move(value)), hash_(val.hash()) {}
+
+big_integer const& hashed_big_integer::value() const {
+  return val;
+}
+
+size_t hashed_big_integer::hash() const {
+  return hash_;
+}
+
+bool operator==(hashed_big_integer const& a, hashed_big_integer const& b) {
+  return a.hash_ == b.hash_ && a.val == b.val;
+}
+
+bool operator!=(hashed_big_integer const& a, hashed_big_integer const& b) {
+  return !(a == b);
+}
+
+big_integer_batch::big_integer_batch(size_t lanes, size_t width)
+    : lanes_(lanes), width_(width) {
+  if (width == 0) {
+    throw std::invalid_argument("Zero batch width");
+  }
+  data.resize(lanes * width, 0);
+}
+
+size_t big_integer_batch::lanes() const {
+  return lanes_;
+}
+
+size_t big_integer_batch::width() const {
+  return width_;
+}
+
+limb* big_integer_batch::column(size_t k) {
+  return data.data() + k * lanes_;
+}
+
+limb const* big_integer_batch::column(size_t k) const {
+  return data.data() + k * lanes_;
+}
+
+big_integer big_integer_batch::get(size_t lane) const {
+  big_integer res;
+  res.num.resize(width_, 0);
+  for (size_t k = 0; k < width_; k++) {
+    res.num[k] = data[k * lanes_ + lane];
+  }
+  res.sign = res.leadingBit();
+  res.fixLeadingBits();
+  return res;
+}
+
+void big_integer_batch::set(size_t lane, big_integer const& a) {
+  if (a.num.size() > width_) {
+    throw std::invalid_argument("Number is wider than batch");
+  }
+  for (size_t k = 0; k < width_; k++) {
+    data[k * lanes_ + lane] = k < a.num.size() ? a.num[k] : a.signBits();
+  }
+}
+
+// Чисел набора в блоке умножения
+#ifndef BIGINT_BATCH_BLOCK
+#define BIGINT_BATCH_BLOCK 64
+#endif
+static const size_t BATCH_BLOCK = BIGINT_BATCH_BLOCK;
+
+// Наборы, где меньший множитель не короче этого, умножаются по одному
+// числу обычным *: умножение по столбцам квадратично и дальше проигрывает
+// ему. С 32-битными разрядами цикл по числам векторизуется, и порог выше
+#ifndef BIGINT_BATCH_MUL_THRESHOLD
+#if BIGINT_LIMB_BITS == 64
+#define BIGINT_BATCH_MUL_THRESHOLD 12
+#else
+#define BIGINT_BATCH_MUL_THRESHOLD 48
+#endif
+#endif
+static const size_t BATCH_MUL_THRESHOLD = BIGINT_BATCH_MUL_THRESHOLD;
+
+static void checkLanes(big_integer_batch const& a,
+                       big_integer_batch const& b) {
+  if (a.lanes() != b.lanes()) {
+    throw std::invalid_argument("Batches of different sizes");
+  }
+}
+
+// Разряды знака старшего столбца: за шириной числа продолжается этот
+// столбец
+static void batchSigns(big_integer_batch const& a, limb* signs) {
+  limb const* top = a.column(a.width() - 1);
+  for (size_t l = 0; l < a.lanes(); l++) {
+    signs[l] = static_cast<limb>(static_cast<slimb>(top[l]) >> (BASE - 1));
+  }
+}
+
+// Столбец k с расширением знаком
+static limb const* batchColumn(big_integer_batch const& a, size_t k,
+                               limb const* signs) {
+  return k < a.width() ? a.column(k) : signs;
+}
+
+// res = a + b или a - b = a + ~b + 1, перенос каждого числа -- в carry
+static void batchAddSub(big_integer_batch& res, big_integer_batch const& a,
+                        big_integer_batch const& b, bool subtract) {
+  checkLanes(res, a);
+  checkLanes(res, b);
+  size_t lanes = res.lanes();
+  vector<limb> buf;
+  buf.resize(3 * lanes, subtract ? 1 : 0);
+  limb* signA = buf.data();
+  limb* signB = signA + lanes;
+  limb* carry = signB + lanes;
+  batchSigns(a, signA);
+  batchSigns(b, signB);
+  limb flip = subtract ? ~static_cast<limb>(0) : 0;
+  for (size_t k = 0; k < res.width(); k++) {
+    limb const* x = batchColumn(a, k, signA);
+    limb const* y = batchColumn(b, k, signB);
+    limb* r = res.column(k);
+    for (size_t l = 0; l < lanes; l++) {
+      limb t = x[l] + carry[l];
+      limb c = t < carry[l];
+      limb u = y[l] ^ flip;
+      t += u;
+      carry[l] = c + (t < u);
+      r[l] = t;
+    }
+  }
+}
+
+void add(big_integer_batch& res, big_integer_batch const& a,
+         big_integer_batch const& b) {
+  batchAddSub(res, a, b, false);
+}
+
+void sub(big_integer_batch& res, big_integer_batch const& a,
+         big_integer_batch const& b) {
+  batchAddSub(res, a, b, true);
+}
+
+void mul(big_integer_batch& res, big_integer_batch const& a,
+         big_integer_batch const& b) {
+  checkLanes(res, a);
+  checkLanes(res, b);
+  if (&res == &a || &res == &b) {
+    big_integer_batch t(res.lanes(), res.width());
+    mul(t, a, b);
+    res = std::move(t);
+    return;
+  }
+  size_t lanes = res.lanes();
+  size_t wa = a.width();
+  size_t wb = b.width();
+  if (std::min(wa, wb) >= BATCH_MUL_THRESHOLD) {
+    // Модули множителей умножаются как у operator*, модуль самого
+    // отрицательного числа -- то же число без знака
+    vector<limb> buf;
+    buf.resize(2 * (wa + wb), 0);
+    limb* x = buf.data();
+    limb* y = x + wa;
+    limb* p = y + wb;
+    for (size_t l = 0; l < lanes; l++) {
+      for (size_t k = 0; k < wa; k++) {
+        x[k] = a.column(k)[l];
+      }
+      for (size_t k = 0; k < wb; k++) {
+        y[k] = b.column(k)[l];
+      }
+      bool negative = isNegative(x, wa) != isNegative(y, wb);
+      if (isNegative(x, wa)) {
+        negLimbs(x, wa);
+      }
+      if (isNegative(y, wb)) {
+        negLimbs(y, wb);
+      }
+      mulLimbs(x, wa, y, wb, p);
+      if (negative) {
+        negLimbs(p, wa + wb);
+      }
+      limb fill = isNegative(p, wa + wb) ? ~limb(0) : 0;
+      for (size_t k = 0; k < res.width(); k++) {
+        res.column(k)[l] = k < wa + wb ? p[k] : fill;
+      }
+    }
+    return;
+  }
+  size_t n = std::min(res.width(), wa + wb);
+  vector<limb> buf;
+  buf.resize(5 * lanes, 0);
+  limb* signA = buf.data();
+  limb* signB = signA + lanes;
+  limb* acc0 = signB + lanes;
+  limb* acc1 = acc0 + lanes;
+  limb* acc2 = acc1 + lanes;
+  batchSigns(a, signA);
+  batchSigns(b, signB);
+  // Числа идут блоками, чтобы накопители и столбцы множителей блока
+  // оставались в кеше
+  for (size_t from = 0; from < lanes; from += BATCH_BLOCK) {
+    size_t to = std::min(lanes, from + BATCH_BLOCK);
+    // Произведение разрядов без знака по столбцам результата: в столбец k
+    // собираются все a[i] * b[k - i] в трёхразрядный накопитель
+    for (size_t k = 0; k < n; k++) {
+      for (size_t i = k < wb ? 0 : k - wb + 1; i <= k && i < wa; i++) {
+        limb const* x = a.column(i);
+        limb const* y = b.column(k - i);
+        for (size_t l = from; l < to; l++) {
+          dlimb p = static_cast<dlimb>(x[l]) * y[l];
+          limb lo = static_cast<limb>(p);
+          // Старший разряд произведения не больше B - 2
+          limb hi = static_cast<limb>(p >> BASE);
+          acc0[l] += lo;
+          hi += acc0[l] < lo;
+          acc1[l] += hi;
+          acc2[l] += acc1[l] < hi;
+        }
+      }
+      limb* r = res.column(k);
+      for (size_t l = from; l < to; l++) {
+        r[l] = acc0[l];
+        acc0[l] = acc1[l];
+        acc1[l] = acc2[l];
+        acc2[l] = 0;
+      }
+    }
+    // Отрицательный a равен a_u - B^wa, поэтому из произведения без знака
+    // вычитается b * B^wa, и так же a * B^wb для отрицательного b.
+    // Слагаемое B^(wa + wb) за шириной точного произведения
+    for (int pass = 0; pass < 2; pass++) {
+      big_integer_batch const& other = pass == 0 ? b : a;
+      limb const* mask = pass == 0 ? signA : signB;
+      size_t shift = pass == 0 ? wa : wb;
+      limb* borrow = acc0;
+      std::fill(borrow + from, borrow + to, 0);
+      for (size_t k = shift; k < n; k++) {
+        limb const* y = other.column(k - shift);
+        limb* r = res.column(k);
+        for (size_t l = from; l < to; l++) {
+          limb u = (y[l] & mask[l]) + borrow[l];
+          limb c = u < borrow[l];
+          borrow[l] = c + (r[l] < u);
+          r[l] -= u;
+        }
+      }
+    }
+  }
+  if (n < res.width()) {
+    limb const* top = res.column(n - 1);
+    for (size_t l = 0; l < lanes; l++) {
+      signA[l] = static_cast<limb>(static_cast<slimb>(top[l]) >> (BASE - 1));
+    }
+    for (size_t k = n; k < res.width(); k++) {
+      std::copy(signA, signA + lanes, res.column(k));
+    }
+  }
+}
+
+void compare(big_integer_batch const& a, big_integer_batch const& b,
+             int32_t* res) {
+  checkLanes(a, b);
+  size_t lanes = a.lanes();
+  size_t w = std::max(a.width(), b.width());
+  vector<limb> buf;
+  buf.resize(2 * lanes, 0);
+  limb* signA = buf.data();
+  limb* signB = signA + lanes;
+  batchSigns(a, signA);
+  batchSigns(b, signB);
+  std::fill(res, res + lanes, 0);
+  // От старшего столбца к младшему, пока есть неразличённые числа; в
+  // старшем знаковый бит инвертируется, чтобы сравнение без знака
+  // упорядочило отрицательные раньше
+  limb flip = static_cast<limb>(1) << (BASE - 1);
+  size_t equal = lanes;
+  for (size_t k = w; k-- > 0 && equal != 0; flip = 0) {
+    limb const* x = batchColumn(a, k, signA);
+    limb const* y = batchColumn(b, k, signB);
+    equal = 0;
+    for (size_t l = 0; l < lanes; l++) {
+      limb u = x[l] ^ flip;
+      limb v = y[l] ^ flip;
+      int32_t c = static_cast<int32_t>(u > v) - static_cast<int32_t>(u < v);
+      res[l] = res[l] != 0 ? res[l] : c;
+      equal += res[l] == 0;
+    }
+  }
+}
+
+void divmod(big_integer const& a, big_integer const& b, big_integer& quot,
+            big_integer& rem) {
+  if (&quot == &rem) {
+    throw std::invalid_argument("Same quotient and remainder in divmod");
+  }
+  if (&quot == &a || &quot == &b || &rem == &b) {
+    big_integer_divmod res = divmod(a, b);
+    quot = std::move(res.quot);
+    rem = std::move(res.rem);
+    return;
+  }
+  // При делении на ноль divRem бросает до изменения quot, rem не тронут
+  big_integer res = a;
+  res.divRem(b, quot);
+  rem = std::move(res);
+}
+
+void divmod_floor(big_integer const& a, big_integer const& b,
+                  big_integer& quot, big_integer& rem) {
+  // b запоминается до деления: rem может совпадать с ним
+  bool negative = b < 0;
+  big_integer copy;
+  big_integer const* divisor = &b;
+  if (&b == &quot || &b == &rem) {
+    copy = b;
+    divisor = &copy;
+  }
+  divmod(a, b, quot, rem);
+  if (rem != 0 && (rem < 0) != negative) {
+    quot -= 1;
+    rem += *divisor;
+  }
+}
+
+big_integer_divmod divmod(big_integer const& a, big_integer const& b) {
+  big_integer_divmod res;
+  divmod(a, b, res.quot, res.rem);
+  return res;
+}
+
+big_integer_divmod divmod_floor(big_integer const& a, big_integer const& b) {
+  big_integer_divmod res;
+  divmod_floor(a, b, res.quot, res.rem);
+  return res;
+}
+
+// Вычеты по нечётному модулю m из n разрядов в представлении Монтгомери
+// x * R mod m, R = B^n
+struct mont_field {
+  limb const* m;
+  size_t n;
+  limb negInv; // -m^(-1) mod B
+  vector<limb> t;
+
+  mont_field(limb const* m, size_t n) : m(m), n(n) {
+    limb inv = m[0];
+    for (int i = 0; i < 5; i++) {
+      inv *= 2 - m[0] * inv;
+    }
+    negInv = 0 - inv;
+    t.resize(n + 1, 0);
+  }
+
+  // res[0, n) = a * b / R mod m для a, b < m, res может совпадать с a, b.
+  // Прибавление a * b[i] и шаг редукции q * m идут в одном проходе
+  // по разрядам (CIOS), промежуточное значение t[0, n + 1) меньше 2m
+  void mul(limb const* a, limb const* b, limb* res) {
+    std::fill(t.begin(), t.end(), 0);
+    for (size_t i = 0; i < n; i++) {
+      limb cur = b[i];
+      dlimb prod = t[0] + static_cast<dlimb>(a[0]) * cur;
+      // q выбирается так, чтобы t + a * b[i] + q * m делилось на B
+      limb q = static_cast<limb>(prod) * negInv;
+      dlimb red = (static_cast<limb>(prod) + static_cast<dlimb>(q) * m[0]) >>
+                  BASE;
+      prod >>= BASE;
+      for (size_t j = 1; j < n; j++) {
+        prod += t[j] + static_cast<dlimb>(a[j]) * cur;
+        red += static_cast<limb>(prod) + static_cast<dlimb>(q) * m[j];
+        t[j - 1] = static_cast<limb>(red);
+        prod >>= BASE;
+        red >>= BASE;
+      }
+      prod += t[n];
+      red += static_cast<limb>(prod);
+      t[n - 1] = static_cast<limb>(red);
+      t[n] = static_cast<limb>(prod >> BASE) + static_cast<limb>(red >> BASE);
+    }
+    if (t[n] != 0 || !lessLimbs(t.data(), m, n)) {
+      subLimbs(t.data(), n, m, n);
+    }
+    std::copy(t.begin(), t.begin() + n, res);
+  }
+};
+
+// Ширина окна по длине показателя: 2^(k - 1) предвычисленных степеней
+// против примерно bits / (k + 1) умножений
+static size_t powWindowBits(size_t bits) {
+  return bits <= 24 ? 2 : bits <= 96 ? 3 : bits <= 384 ? 4 : bits <= 1536 ? 5 : 6;
+}
+
+big_integer powmod(big_integer const& base, big_integer const& exp,
+                   big_integer const& mod) {
+  if (mod <= 0) {
+    throw std::invalid_argument("Non-positive modulus in powmod");
+  }
+  if (exp < 0) {
+    throw std::invalid_argument("Negative exponent in powmod");
+  }
+  if (mod == 1) {
+    return 0;
+  }
+  big_integer x = divmod_floor(base, mod).rem;
+  size_t len = exp.magnitudeSize();
+  size_t bits = len == 0 ? 0 : len * BASE - leadingZeros(exp.num[len - 1]);
+  auto bit = [&](size_t i) {
+    return ((exp.num[i / BASE] >> (i % BASE)) & 1) != 0;
+  };
+  if ((mod.num[0] & 1) == 0) {
+    big_integer res = 1;
+    for (size_t i = bits; i-- > 0;) {
+      res = res * res % mod;
+      if (bit(i)) {
+        res = res * x % mod;
+      }
+    }
+    return res;
+  }
+  if (bits == 0) {
+    return 1;
+  }
+
+  size_t n = mod.magnitudeSize();
+  mont_field f(mod.num.data(), n);
+  size_t k = powWindowBits(bits);
+  size_t powers = size_t(1) << (k - 1);
+  // R^2 mod m, x^2, результат, x^1, x^3, ..., x^(2^k - 1)
+  vector<limb> buf;
+  buf.resize(3 * n + powers * n, 0);
+  limb* r2 = buf.data();
+  limb* sqr = r2 + n;
+  limb* acc = sqr + n;
+  limb* table = acc + n;
+
+  big_integer r = (big_integer(1) << (2 * n * BASE)) % mod;
+  std::copy(r.num.data(), r.num.data() + r.magnitudeSize(), r2);
+  std::copy(x.num.data(), x.num.data() + x.magnitudeSize(), acc);
+  f.mul(acc, r2, table);
+  f.mul(table, table, sqr);
+  for (size_t i = 1; i < powers; i++) {
+    f.mul(table + (i - 1) * n, sqr, table + i * n);
+  }
+
+  // Окно -- не больше k битов показателя, начинающихся и кончающихся
+  // единицей; нули между окнами дают только возведения в квадрат
+  bool started = false;
+  for (size_t pos = bits; pos > 0;) {
+    if (!bit(pos - 1)) {
+      f.mul(acc, acc, acc);
+      pos--;
+      continue;
+    }
+    size_t low = pos > k ? pos - k : 0;
+    while (!bit(low)) {
+      low++;
+    }
+    size_t window = 0;
+    for (size_t i = pos; i-- > low;) {
+      window = 2 * window + (bit(i) ? 1 : 0);
+      if (started) {
+        f.mul(acc, acc, acc);
+      }
+    }
+    limb const* power = table + (window / 2) * n;
+    if (started) {
+      f.mul(acc, power, acc);
+    } else {
+      std::copy(power, power + n, acc);
+      started = true;
+    }
+    pos = low;
+  }
+
+  std::fill(sqr, sqr + n, 0);
+  sqr[0] = 1;
+  big_integer res;
+  res.num.resize(n + 1, 0);
+  f.mul(acc, sqr, res.num.data());
+  res.fixLeadingBits();
   return res;
 }
 
-big_integer operator+(big_integer a, big_integer const& b) {
-  a += b;
-  return a;
+modulus_context::modulus_context(big_integer const& mod) : mod(mod) {
+  if (mod <= 0) {
+    throw std::invalid_argument("Non-positive modulus in modulus_context");
+  }
+  n = mod.magnitudeSize();
+  shift = leadingZeros(mod.num[n - 1]);
+  norm = mod << shift;
+  // Для m' = 2^(BASE * n - 1) обратное равно B^n и не помещается в n
+  // разрядов; B^n - 1 уменьшает оценку частного не больше чем на 1
+  inv = (big_integer(1) << (2 * n * BASE)) / norm -
+        (big_integer(1) << (n * BASE));
+  if (inv.magnitudeSize() > n) {
+    inv -= 1;
+  }
+  inv.setLen(n);
 }
 
-big_integer operator-(big_integer a, big_integer const& b) {
-  a -= b;
-  return a;
+big_integer const& modulus_context::modulus() const {
+  return mod;
 }
 
-big_integer operator*(big_integer a, big_integer const& b) {
-  a *= b;
-  return a;
+// res[n, 2n) -- старшие разряды a[0, n) * b[0, n) без столбцов младше
+// n - 2: отброшенное меньше B^n, поэтому результат меньше точного не
+// больше чем на 1. res[0, n - 2) не меняется
+static void mulHighSchool(limb const* a, limb const* b, size_t n,
+                          limb* res) {
+  size_t low = n < 2 ? 0 : n - 2;
+  std::fill(res + low, res + 2 * n, 0);
+  for (size_t i = 0; i < n; i++) {
+    dlimb carry = 0;
+    for (size_t j = i < low ? low - i : 0; j < n; j++) {
+      carry += static_cast<dlimb>(a[i]) * b[j] + res[i + j];
+      res[i + j] = static_cast<limb>(carry);
+      carry >>= BASE;
+    }
+    res[i + n] = static_cast<limb>(carry);
+  }
 }
 
-big_integer operator/(big_integer a, big_integer const& b) {
-  a /= b;
-  return a;
+// res[0, len) = a[0, n) * b[0, m) mod B^len
+static void mulLowSchool(limb const* a, size_t n, limb const* b, size_t m,
+                         size_t len, limb* res) {
+  std::fill(res, res + len, 0);
+  for (size_t i = 0; i < n && i < len; i++) {
+    dlimb carry = 0;
+    size_t end = std::min(m, len - i);
+    for (size_t j = 0; j < end; j++) {
+      carry += static_cast<dlimb>(a[i]) * b[j] + res[i + j];
+      res[i + j] = static_cast<limb>(carry);
+      carry >>= BASE;
+    }
+    if (i + m < len) {
+      res[i + m] = static_cast<limb>(carry);
+    }
+  }
 }
 
-big_integer operator%(big_integer a, big_integer const& b) {
-  a %= b;
-  return a;
+size_t modulus_context::blockScratch() const {
+  return 5 * n + 1 + karatsubaScratch(n);
 }
 
-big_integer operator&(big_integer a, big_integer const& b) {
-  a &= b;
-  return a;
+void modulus_context::reduceBlock(limb* y, limb* scratch) const {
+  limb const* m = norm.num.data();
+  limb* t = scratch;
+  limb* q = t + 2 * n;
+  limb* qm = q + n + 1;
+  limb* rest = qm + 2 * n;
+  // q = q1 + floor(q1 * inv / B^n) для q1 = floor(y / B^n) не больше
+  // частного и меньше его не более чем на 5: 3 у самой оценки, по 1 от
+  // обратного B^n - 1 и от отброшенных столбцов. Нужна только старшая
+  // половина q1 * inv, и q < 2 * B^n
+  if (n < BARRETT_SHORT_THRESHOLD) {
+    mulHighSchool(y + n, inv.num.data(), n, t);
+  } else {
+    mulRec(y + n, n, inv.num.data(), n, t, rest);
+  }
+  std::copy(t + n, t + 2 * n, q);
+  q[n] = addLimbs(q, n, y + n, n);
+  // Остаток меньше 6m' < B^(n + 1), поэтому хватает n + 1 младших разрядов
+  // q * m'
+  if (n < BARRETT_SHORT_THRESHOLD) {
+    mulLowSchool(q, n + 1, m, n, n + 1, qm);
+  } else {
+    mulRec(q, n, m, n, qm, rest);
+    qm[n] += q[n] * m[0];
+  }
+  subLimbs(y, n + 1, qm, n + 1);
+  std::fill(y + n + 1, y + 2 * n, 0);
+  while (y[n] != 0 || !lessLimbs(y, m, n)) {
+    y[n] -= subLimbs(y, n, m, n);
+  }
 }
 
-big_integer operator|(big_integer a, big_integer const& b) {
-  return a |= b;
+big_integer modulus_context::reduce(big_integer const& a) const {
+  // От NTT_THRESHOLD до 2 * NTT_THRESHOLD оба произведения идут через
+  // NTT, а деление умножает половины Тоомом-3 и оказывается быстрее
+  if (n >= NTT_THRESHOLD && n < 2 * NTT_THRESHOLD) {
+    return divmod_floor(a, mod).rem;
+  }
+  big_integer abs;
+  big_integer const* x = &a;
+  if (a.sign != 0) {
+    abs = -a;
+    x = &abs;
+  }
+  // |a| * 2^shift приводится по m' блоками по n разрядов от старших:
+  // остаток с приписанным блоком меньше m' * B^n
+  size_t len = x->magnitudeSize();
+  size_t blockLen = blockScratch();
+  size_t xsLen = std::max(len + 1, 2 * n) + n;
+  if (buffer.size() < blockLen + xsLen) {
+    buffer.resize(blockLen + xsLen, 0);
+  }
+  limb* scratch = buffer.data();
+  limb* xs = scratch + blockLen;
+  std::fill(xs + len, xs + xsLen, 0);
+  xs[len] = shlLimbs(x->num.data(), len, shift, xs);
+  if (xs[len] != 0) {
+    len++;
+  }
+  size_t blocks = std::max<size_t>((len + n - 1) / n, 2);
+  limb* top = xs + (blocks - 1) * n;
+  if (!lessLimbs(top, norm.num.data(), n)) {
+    subLimbs(top, n, norm.num.data(), n);
+  }
+  for (size_t i = blocks - 1; i-- > 0;) {
+    reduceBlock(xs + i * n, scratch);
+  }
+  shrLimbs(xs, n, shift);
+  big_integer res;
+  res.num.resize(n + 1, 0);
+  std::copy(xs, xs + n, res.num.data());
+  res.fixLeadingBits();
+  if (a.sign != 0 && res != 0) {
+    res = mod - res;
+  }
+  return res;
 }
 
-big_integer operator^(big_integer a, big_integer const& b) {
-  a ^= b;
-  return a;
+big_integer modulus_context::mulmod(big_integer const& a,
+                                    big_integer const& b) const {
+  return reduce(a * b);
 }
 
-big_integer operator<<(big_integer a, int b) {
-  return a <<= b;
+big_integer modulus_context::addmod(big_integer const& a,
+                                    big_integer const& b) const {
+  big_integer res = a + b;
+  if (res >= mod) {
+    res -= mod;
+  }
+  return res;
 }
 
-big_integer operator>>(big_integer a, int b) {
-  return a >>= b;
+big_integer modulus_context::submod(big_integer const& a,
+                                    big_integer const& b) const {
+  big_integer res = a - b;
+  if (res < 0) {
+    res += mod;
+  }
+  return res;
 }
 
-int32_t big_integer::compareTo(const big_integer& a) const {
-  if (sign == 0 && a.sign != 0) {
-    return 1;
+// res[0, n) = a[0, n) * x - b[0, n) * y, результат должен лежать в [0, B^n)
+static void mulSubMul(limb const* a, limb x, limb const* b, limb y, size_t n,
+                      limb* res) {
+  limb carryA = 0;
+  limb carryB = 0;
+  limb borrow = 0;
+  for (size_t i = 0; i < n; i++) {
+    dlimb pa = static_cast<dlimb>(a[i]) * x + carryA;
+    dlimb pb = static_cast<dlimb>(b[i]) * y + carryB;
+    carryA = static_cast<limb>(pa >> BASE);
+    carryB = static_cast<limb>(pb >> BASE);
+    dlimb cur = static_cast<dlimb>(static_cast<limb>(pa)) -
+                static_cast<limb>(pb) - borrow;
+    res[i] = static_cast<limb>(cur);
+    borrow = static_cast<limb>(cur >> BASE) != 0 ? 1 : 0;
   }
-  if (sign != 0 && a.sign == 0) {
-    return -1;
+}
+
+// res[0, n) = a[0, n) * x + b[0, n) * y, возвращает старший разряд
+static limb mulAddMul(limb const* a, limb x, limb const* b, limb y, size_t n,
+                      limb* res) {
+  limb carry = 0;
+  for (size_t i = 0; i < n; i++) {
+    dlimb pa = static_cast<dlimb>(a[i]) * x + carry;
+    dlimb cur = static_cast<dlimb>(b[i]) * y + static_cast<limb>(pa);
+    res[i] = static_cast<limb>(cur);
+    carry = static_cast<limb>(pa >> BASE) + static_cast<limb>(cur >> BASE);
   }
-  for (int32_t i = std::max(a.num.size(), num.size()) - 1; i >= 0; i--) {
-    int64_t cur = (i < num.size() ? num[i] : signBits());
-    cur -= (i < a.num.size() ? a.num[i] : a.signBits());
-    if (cur > 0) {
-      return 1;
-    } else if (cur < 0) {
-      return -1;
+  return carry;
+}
+
+// Биты [shift, shift + 2 * BASE) числа a[0, n)
+static dlimb bitsAt(limb const* a, size_t n, size_t shift) {
+  size_t i = shift / BASE;
+  uint32_t off = shift % BASE;
+  auto at = [&](size_t j) { return j < n ? a[j] : static_cast<limb>(0); };
+  dlimb res = (static_cast<dlimb>(at(i + 1)) << BASE) | at(i);
+  if (off != 0) {
+    res = (res >> off) | (static_cast<dlimb>(at(i + 2)) << (2 * BASE - off));
+  }
+  return res;
+}
+
+// floor(x / y) для 0 <= x и 0 < y. Частные шагов Евклида обычно малы,
+// такие дешевле найти вычитанием, чем делением удвоенных разрядов
+static sdlimb quotientOf(sdlimb x, sdlimb y) {
+  if ((x >> 2) < y) {
+    sdlimb q = 0;
+    while (x >= y) {
+      x -= y;
+      q++;
     }
+    return q;
   }
-  return 0;
+  if ((static_cast<dlimb>(x) >> BASE) == 0) {
+    return static_cast<limb>(x) / static_cast<limb>(y);
+  }
+  return x / y;
 }
 
-bool operator==(big_integer const& a, big_integer const& b) {
-  return a.compareTo(b) == 0;
+// Матрица шагов Евклида: (a, b) -> (u0 a + u1 b, v0 a + v1 b). Знаки в
+// каждой строке противоположны, определитель равен ±1
+struct gcd_step {
+  slimb u0, u1, v0, v1;
+};
+
+// Матрица шагов Евклида N = ±[[m00, -m01], [-m10, m11]] с определителем
+// ±1: (a', b') = N (a, b). Знаки у всех таких матриц расставлены так, и
+// произведения складываются из модулей без вычитаний
+struct gcd_matrix {
+  big_integer m[2][2] = {{1, 0}, {0, 1}};
+  bool neg = false;
+
+  // (x, y) = N (x, y) для любых x, y
+  void apply(big_integer& x, big_integer& y) const {
+    big_integer nx = m[0][0] * x - m[0][1] * y;
+    y = m[1][1] * y - m[1][0] * x;
+    x = std::move(nx);
+    if (neg) {
+      x = -x;
+      y = -y;
+    }
+  }
+
+  void swapRows() {
+    std::swap(m[0][0], m[1][0]);
+    std::swap(m[0][1], m[1][1]);
+    neg = !neg;
+  }
+
+  // N = A N
+  void apply(gcd_matrix const& A) {
+    for (size_t j = 0; j < 2; j++) {
+      big_integer top = A.m[0][0] * m[0][j] + A.m[0][1] * m[1][j];
+      m[1][j] = A.m[1][0] * m[0][j] + A.m[1][1] * m[1][j];
+      m[0][j] = std::move(top);
+    }
+    neg = neg != A.neg;
+  }
+};
+
+// Наибольший общий делитель: шаги Евклида над разрядами неотрицательных
+// чисел на месте, при необходимости с накоплением матрицы шагов
+struct gcd_state {
+  // Шаги Лемера (Кнут, алгоритм L) по старшим 2 * BASE - 2 битам a >= b > 0
+  // с коэффициентами меньше 2^(BASE - 1). При low != 0 остатки не
+  // опускаются ниже 2^low: так половинный НОД не проскакивает свою
+  // границу. false, если
+  // ни одного частного по старшим битам определить нельзя
+  static bool lehmerStep(big_integer const& a, big_integer const& b,
+                         size_t low, gcd_step& s) {
+    size_t n = a.magnitudeSize();
+    size_t bits = a.bitLength();
+    size_t shift = bits > 2 * BASE - 2 ? bits - (2 * BASE - 2) : 0;
+    size_t m = std::min(b.magnitudeSize(), n);
+    sdlimb x = static_cast<sdlimb>(bitsAt(a.num.data(), n, shift));
+    sdlimb y = static_cast<sdlimb>(bitsAt(b.num.data(), m, shift));
+    const sdlimb limit = static_cast<sdlimb>(1) << (BASE - 1);
+    // Остаток по старшим битам отличается от истинного (после сдвига)
+    // меньше чем на наибольший из коэффициентов строки
+    sdlimb least = 0;
+    if (low != 0) {
+      if (low >= shift + 2 * BASE - 2) {
+        return false;
+      }
+      least = low >= shift ? static_cast<sdlimb>(1) << (low - shift) : 1;
+    }
+    sdlimb u0 = 1, u1 = 0, v0 = 0, v1 = 1;
+    bool progress = false;
+    while (y + v0 > 0 && y + v1 > 0 && x + u0 >= 0 && x + u1 >= 0) {
+      sdlimb d0 = y + v0, d1 = y + v1;
+      sdlimb q = quotientOf(x + u0, d0);
+      if (q >= limit) {
+        break;
+      }
+      // Вторая граница проверяется умножением, q * d1 < 2^(2 * BASE)
+      dlimb t = static_cast<dlimb>(q) * static_cast<dlimb>(d1);
+      dlimb n1 = static_cast<dlimb>(x + u1);
+      if (t > n1 || n1 - t >= static_cast<dlimb>(d1)) {
+        break;
+      }
+      sdlimb w0 = u0 - q * v0;
+      sdlimb w1 = u1 - q * v1;
+      sdlimb z = x - q * y;
+      sdlimb big = std::max(w0 < 0 ? -w0 : w0, w1 < 0 ? -w1 : w1);
+      if (big >= limit || (least != 0 && z < least + big)) {
+        break;
+      }
+      u0 = v0;
+      u1 = v1;
+      v0 = w0;
+      v1 = w1;
+      x = y;
+      y = z;
+      progress = true;
+    }
+    s = {static_cast<slimb>(u0), static_cast<slimb>(u1),
+         static_cast<slimb>(v0), static_cast<slimb>(v1)};
+    return progress;
+  }
+
+  // (a, b) = S (a, b) по разрядам, ta и tb -- буферы для результата
+  static void applyStep(big_integer& a, big_integer& b, gcd_step const& s,
+                        big_integer& ta, big_integer& tb) {
+    size_t n = a.magnitudeSize();
+    a.setLen(n);
+    b.setLen(n);
+    ta.num.resize(n + 1, 0);
+    tb.num.resize(n + 1, 0);
+    applyRow(a, b, s.u0, s.u1, ta.num.data(), n);
+    applyRow(a, b, s.v0, s.v1, tb.num.data(), n);
+    ta.num[n] = 0;
+    tb.num[n] = 0;
+    ta.sign = 0;
+    tb.sign = 0;
+    ta.fixLeadingBits();
+    tb.fixLeadingBits();
+  }
+
+  static void applyRow(big_integer const& a, big_integer const& b, slimb x,
+                       slimb y, limb* res, size_t n) {
+    if (y <= 0) {
+      mulSubMul(a.num.data(), static_cast<limb>(x), b.num.data(),
+                static_cast<limb>(-y), n, res);
+    } else {
+      mulSubMul(b.num.data(), static_cast<limb>(y), a.num.data(),
+                static_cast<limb>(-x), n, res);
+    }
+  }
+
+  // N = S N: модули новой строки -- |s0| (строка 0) + |s1| (строка 1)
+  static void applyStep(gcd_matrix& N, gcd_step const& s, big_integer& t0,
+                        big_integer& t1) {
+    for (size_t j = 0; j < 2; j++) {
+      big_integer& p = N.m[0][j];
+      big_integer& r = N.m[1][j];
+      size_t n = std::max<size_t>(
+          std::max(p.magnitudeSize(), r.magnitudeSize()), 1);
+      p.setLen(n);
+      r.setLen(n);
+      t0.num.resize(n + 2, 0);
+      t1.num.resize(n + 2, 0);
+      t0.num[n] = mulAddMul(p.num.data(), absLimb(s.u0), r.num.data(),
+                            absLimb(s.u1), n, t0.num.data());
+      t1.num[n] = mulAddMul(p.num.data(), absLimb(s.v0), r.num.data(),
+                            absLimb(s.v1), n, t1.num.data());
+      t0.num[n + 1] = 0;
+      t1.num[n + 1] = 0;
+      t0.sign = 0;
+      t1.sign = 0;
+      t0.fixLeadingBits();
+      t1.fixLeadingBits();
+      p.swap(t0);
+      r.swap(t1);
+    }
+    if (s.u0 < 0 || s.u1 > 0) {
+      N.neg = !N.neg;
+    }
+  }
+
+  static limb absLimb(slimb x) {
+    return x < 0 ? static_cast<limb>(0) - static_cast<limb>(x)
+                 : static_cast<limb>(x);
+  }
+
+  // Половинный НОД (Мёллер): для s = n / 2 + 1, n -- длина большего из
+  // a, b, вычитает кратное меньшего из большего, пока оба не меньше B^s,
+  // до |a - b| < B^s. Если N не nullptr, шаги накапливаются в нём, на
+  // входе N единичная
+  static void hgcd(big_integer& a, big_integer& b, gcd_matrix* N) {
+    size_t n = std::max(a.magnitudeSize(), b.magnitudeSize());
+    size_t s = n / 2 + 1;
+    if (a.magnitudeSize() <= s || b.magnitudeSize() <= s) {
+      return;
+    }
+    if (n >= HGCD_THRESHOLD) {
+      // Приведённая пара старших n - s разрядов больше коэффициентов
+      // почти в B^s раз, поэтому на полных числах остаётся не меньше B^s
+      gcd_matrix N1;
+      hgcdHigh(a, b, s, N1);
+      if (N != nullptr) {
+        *N = std::move(N1);
+      }
+      if (!hgcdSteps(a, b, s, N, 1)) {
+        return;
+      }
+      // Второй раз по старшим 2(l - s) разрядам: граница l - s + 1 для
+      // них поднимается ровно до B^s
+      size_t l = std::max(a.magnitudeSize(), b.magnitudeSize());
+      if (l > s + 2) {
+        gcd_matrix N2;
+        hgcdHigh(a, b, 2 * s - l, N2);
+        if (N != nullptr) {
+          N->apply(N2);
+        }
+      }
+    }
+    hgcdSteps(a, b, s, N, std::numeric_limits<size_t>::max());
+  }
+
+  // Половинный НОД старших разрядов a и b, начиная с k-го, с переносом на
+  // младшие: a' = a1' B^k + N (a0, b0)
+  static void hgcdHigh(big_integer& a, big_integer& b, size_t k,
+                       gcd_matrix& N) {
+    big_integer a1 = a >> static_cast<int>(k * BASE);
+    big_integer b1 = b >> static_cast<int>(k * BASE);
+    hgcd(a1, b1, &N);
+    big_integer a0 = a.limbRange(0, k);
+    big_integer b0 = b.limbRange(0, k);
+    N.apply(a0, b0);
+    a = (a1 << static_cast<int>(k * BASE)) + a0;
+    b = (b1 << static_cast<int>(k * BASE)) + b0;
+  }
+
+  // До count шагов половинного НОД с границей B^s. false, если пара уже
+  // приведена
+  static bool hgcdSteps(big_integer& a, big_integer& b, size_t s,
+                        gcd_matrix* N, size_t count) {
+    big_integer bound = big_integer(1) << static_cast<int>(s * BASE);
+    big_integer ta, tb, q;
+    for (size_t i = 0; i < count; i++) {
+      if (a < b) {
+        a.swap(b);
+        if (N != nullptr) {
+          N->swapRows();
+        }
+      }
+      if (b < bound || a - b < bound) {
+        return false;
+      }
+      gcd_step st;
+      if (lehmerStep(a, b, s * BASE, st)) {
+        applyStep(a, b, st, ta, tb);
+        a.swap(ta);
+        b.swap(tb);
+        if (N != nullptr) {
+          applyStep(*N, st, ta, tb);
+        }
+        continue;
+      }
+      // a -= q b с q = floor((a - B^s) / b) >= 1 оставляет a >= B^s
+      a -= bound;
+      a.divRem(b, q);
+      a += bound;
+      if (N != nullptr) {
+        for (size_t j = 0; j < 2; j++) {
+          N->m[0][j] += q * N->m[1][j];
+        }
+      }
+    }
+    return true;
+  }
+
+  // НОД неотрицательных a и b. Если N не nullptr, в нём накапливаются
+  // шаги: (НОД, 0) = N (a, b)
+  static big_integer run(big_integer a, big_integer b, gcd_matrix* N) {
+    if (a < b) {
+      a.swap(b);
+      if (N != nullptr) {
+        N->swapRows();
+      }
+    }
+    big_integer ta, tb, q;
+    while (b != 0) {
+      size_t n = a.magnitudeSize();
+      // С коэффициентами шаги Лемера вдвое дороже, и половинный НОД
+      // выгоден раньше
+      size_t threshold =
+          N != nullptr ? GCD_HGCD_THRESHOLD / 2 : GCD_HGCD_THRESHOLD;
+      if (n >= threshold && b.magnitudeSize() > n / 2 + 1) {
+        gcd_matrix H;
+        hgcd(a, b, N != nullptr ? &H : nullptr);
+        if (N != nullptr) {
+          N->apply(H);
+        }
+        if (a < b) {
+          a.swap(b);
+          if (N != nullptr) {
+            N->swapRows();
+          }
+        }
+      } else {
+        gcd_step st;
+        if (lehmerStep(a, b, 0, st)) {
+          applyStep(a, b, st, ta, tb);
+          a.swap(ta);
+          b.swap(tb);
+          if (N != nullptr) {
+            applyStep(*N, st, ta, tb);
+          }
+          continue;
+        }
+      }
+      // Шаг Евклида делением: (a, b) = (b, a mod b)
+      if (b != 0) {
+        a.divRem(b, q);
+        a.swap(b);
+        if (N != nullptr) {
+          for (size_t j = 0; j < 2; j++) {
+            N->m[0][j] += q * N->m[1][j];
+          }
+          N->swapRows();
+        }
+      }
+    }
+    return a;
+  }
+};
+
+big_integer gcd(big_integer const& a, big_integer const& b) {
+  return gcd_state::run(a < 0 ? -a : a, b < 0 ? -b : b, nullptr);
 }
 
-bool operator!=(big_integer const& a, big_integer const& b) {
-  return a.compareTo(b) != 0;
+big_integer gcd_ext(big_integer const& a, big_integer const& b,
+                    big_integer& x, big_integer& y) {
+  gcd_matrix N;
+  big_integer g = gcd_state::run(a < 0 ? -a : a, b < 0 ? -b : b, &N);
+  // g = N00 |a| + N01 |b|, N00 = ±m00, N01 = ∓m01
+  big_integer& cx = N.m[0][0];
+  big_integer& cy = N.m[0][1];
+  if (N.neg != (a < 0)) {
+    cx = -cx;
+  }
+  if (N.neg == (b < 0)) {
+    cy = -cy;
+  }
+  x = std::move(cx);
+  y = std::move(cy);
+  return g;
 }
 
-bool operator<(big_integer const& a, big_integer const& b) {
-  return a.compareTo(b) < 0;
+big_integer modinv(big_integer const& a, big_integer const& m) {
+  if (m <= 0) {
+    throw std::invalid_argument("Non-positive modulus in modinv");
+  }
+  gcd_matrix N;
+  if (gcd_state::run(divmod_floor(a, m).rem, m, &N) != 1) {
+    throw std::invalid_argument("Not invertible in modinv");
+  }
+  return divmod_floor(N.neg ? -N.m[0][0] : N.m[0][0], m).rem;
 }
 
-bool operator>(big_integer const& a, big_integer const& b) {
-  return a.compareTo(b) > 0;
+// x^k возведением в квадрат
+static big_integer powSmall(big_integer x, uint32_t k) {
+  big_integer res = 1;
+  for (; k > 0; k >>= 1) {
+    if ((k & 1) != 0) {
+      res *= x;
+    }
+    if (k > 1) {
+      x *= x;
+    }
+  }
+  return res;
 }
 
-bool operator<=(big_integer const& a, big_integer const& b) {
-  return a.compareTo(b) <= 0;
+// floor(v^(1/k)) по битам от старшего, x^k считается с проверкой
+// переполнения
+static uint64_t rootNative(uint64_t v, uint32_t k) {
+  auto fits = [&](uint64_t x) {
+    uint64_t p = 1;
+    for (uint32_t i = 0; i < k; i++) {
+      if (__builtin_mul_overflow(p, x, &p) || p > v) {
+        return false;
+      }
+    }
+    return true;
+  };
+  uint64_t res = 0;
+  for (uint32_t bit = 64 / k + 1; bit-- > 0;) {
+    if (fits(res | (static_cast<uint64_t>(1) << bit))) {
+      res |= static_cast<uint64_t>(1) << bit;
+    }
+  }
+  return res;
 }
 
-bool operator>=(big_integer const& a, big_integer const& b) {
-  return a.compareTo(b) >= 0;
+big_integer iroot(big_integer const& a, uint32_t k) {
+  if (k == 0) {
+    throw std::invalid_argument("Zero degree in iroot");
+  }
+  if (a.sign != 0) {
+    if (k % 2 == 0) {
+      throw std::invalid_argument("Even root of negative number in iroot");
+    }
+    return -iroot(-a, k);
+  }
+  if (k == 1) {
+    return a;
+  }
+  int64_t small;
+  if (a.getSmall(small)) {
+    return rootNative(static_cast<uint64_t>(small), std::min<uint32_t>(k, 64));
+  }
+  size_t m = (a.bitLength() + k - 1) / k;
+  size_t kbits = 32 - __builtin_clz(k);
+  if (m < kbits + 4) {
+    // Корень из нескольких бит -- подбором по битам
+    big_integer res;
+    for (size_t bit = m; bit-- > 0;) {
+      big_integer cur = res | (big_integer(1) << static_cast<int>(bit));
+      if (powSmall(cur, k) <= a) {
+        res = std::move(cur);
+      }
+    }
+    return res;
+  }
+  // Корень из старших бит с точностью до 2^j, j -- примерно половина
+  // длины корня, даёт x >= a^(1/k) с ошибкой не больше 2^j. Шаг Ньютона
+  // сверху не опускается ниже корня, ошибка после него не больше
+  // (k - 1) 2^(2j) / 2^(m - 1) < 1. Вложенные деления нацело дают целую
+  // часть шага, поэтому результат -- корень или на единицу больше, и
+  // достаточно одной проверки
+  size_t j = (m - kbits - 2) / 2;
+  big_integer x = (iroot(a >> static_cast<int>(k * j), k) + 1)
+                  << static_cast<int>(j);
+  if (k == 2) {
+    big_integer res = (x + a / x) >> 1;
+    if (res * res > a) {
+      res -= 1;
+    }
+    return res;
+  }
+  big_integer res = ((k - 1) * x + a / powSmall(x, k - 1)) / k;
+  if (powSmall(res, k) > a) {
+    res -= 1;
+  }
+  return res;
+}
+
+big_integer isqrt(big_integer const& a) {
+  if (a < 0) {
+    throw std::invalid_argument("Square root of negative number in isqrt");
+  }
+  return iroot(a, 2);
 }
 
 std::string to_string(big_integer const& a) {
+  return to_string(a, 10);
+}
+
+std::string to_string(big_integer const& a, uint32_t base) {
+  std::string res(to_chars_size(a, base), '0');
+  char* first = &res[0];
+  res.resize(to_chars(first, first + res.size(), a, base).ptr - first);
+  return res;
+}
+
+size_t big_integer::magnitudeBits() const {
+  if (sign == 0) {
+    return bitLength();
+  }
+  // |a| = ~a + 1 длиннее ~a на бит, только если младшие биты a до старшей
+  // единицы ~a нулевые, то есть |a| -- степень двойки
+  size_t k = num.size();
+  while (k > 0 && num[k - 1] == signBits()) {
+    k--;
+  }
+  if (k == 0) {
+    return 1;
+  }
+  k--;
+  uint32_t top = BASE - leadingZeros(~num[k]);
+  size_t bits = k * BASE + top;
+  limb mask = top == BASE ? ~static_cast<limb>(0)
+                          : (static_cast<limb>(1) << top) - 1;
+  if ((num[k] & mask) != 0) {
+    return bits;
+  }
+  for (size_t i = 0; i < k; i++) {
+    if (num[i] != 0) {
+      return bits;
+    }
+  }
+  return bits + 1;
+}
+
+size_t to_chars_size(big_integer const& a, uint32_t base) {
+  big_integer::radix r = big_integer::makeRadix(base);
+  size_t bits = a.magnitudeBits();
+  size_t digits = r.bits != 0
+                      ? (bits + r.bits - 1) / r.bits
+                      : static_cast<size_t>(bits / std::log2(base)) + 2;
+  return a.sign + std::max<size_t>(digits, 1);
+}
+
+std::to_chars_result to_chars(char* first, char* last, big_integer const& a,
+                              uint32_t base) {
+  big_integer::radix r = big_integer::makeRadix(base);
+  size_t avail = last - first;
   if (a == 0) {
-    return "0";
+    if (avail == 0) {
+      return {last, std::errc::value_too_large};
+    }
+    *first = '0';
+    return {first + 1, std::errc()};
   }
-  std::string res;
-  big_integer copy;
-  copy = a;
-  if (a.sign != 0) {
+  size_t neg = a.sign;
+  if (r.bits != 0) {
+    size_t count = (a.magnitudeBits() + r.bits - 1) / r.bits;
+    if (avail < neg + count) {
+      return {last, std::errc::value_too_large};
+    }
+    if (neg != 0) {
+      *first = '-';
+    }
+    a.writeBits(r.bits, first + neg, count);
+    return {first + neg + count, std::errc()};
+  }
+  big_integer copy = a;
+  if (neg != 0) {
     copy.negate();
   }
-  while (copy != 0) {
-    uint32_t rem = copy.divRemShort(1000000000);
-    std::string tmp = std::to_string(rem);
-    std::reverse(tmp.begin(), tmp.end());
-    res += tmp;
-    if (copy != 0) {
-      for (size_t i = tmp.size(); i < 9; i++) {
-        res += '0';
-      }
+  // *powers[k] = b^(d * 2^k), последняя степень в квадрате больше числа:
+  // 2^(2 * (bits - 1)) не меньше 2^copy.bitLength()
+  vector<big_integer const*> powers;
+  powers.push_back(&big_integer::radixPower(r, 0));
+  while (2 * (powers.back()->bitLength() - 1) < copy.bitLength()) {
+    powers.push_back(&big_integer::radixPower(r, powers.size()));
+  }
+  // Старшая часть пишется без ведущих нулей, поэтому цифрам хватает
+  // to_chars_size символов; во временный буфер -- только если буфер
+  // вызывающего меньше этой оценки
+  size_t bound = to_chars_size(a, base) - neg;
+  char small[256];
+  std::string temp;
+  char* out = first + neg;
+  if (avail < neg + bound) {
+    if (bound <= sizeof(small)) {
+      out = small;
+    } else {
+      temp.resize(bound);
+      out = &temp[0];
     }
   }
-  if (a.sign != 0) {
-    res += '-';
+  size_t count =
+      copy.writeDigits(r, powers, powers.size() - 1, out, false) - out;
+  if (avail < neg + count) {
+    return {last, std::errc::value_too_large};
   }
-  std::reverse(res.begin(), res.end());
-  return res;
+  if (out != first + neg) {
+    std::memcpy(first + neg, out, count);
+  }
+  if (neg != 0) {
+    *first = '-';
+  }
+  return {first + neg + count, std::errc()};
+}
+
+std::from_chars_result from_chars(char const* first, char const* last,
+                                  big_integer& value, uint32_t base) {
+  big_integer::radix r = big_integer::makeRadix(base);
+  char const* digits = first != last && *first == '-' ? first + 1 : first;
+  char const* end = digits;
+  while (end != last && digitValue(*end) < base) {
+    end++;
+  }
+  if (end == digits) {
+    return {first, std::errc::invalid_argument};
+  }
+  big_integer::readAny(r, digits, end - digits).swap(value);
+  if (digits != first) {
+    value.negate();
+  }
+  return {end, std::errc()};
+}
+
+// Основание записи по флагам потока
+static uint32_t streamBase(std::ios_base const& s) {
+  std::ios_base::fmtflags field = s.flags() & std::ios_base::basefield;
+  return field == std::ios_base::hex ? 16 : field == std::ios_base::oct ? 8 : 10;
 }
 
 std::ostream& operator<<(std::ostream& s, big_integer const& a) {
-  return s << to_string(a);
+  return s << to_string(a, streamBase(s));
+}
+
+std::istream& operator>>(std::istream& s, big_integer& a) {
+  std::istream::sentry guard(s);
+  if (!guard) {
+    return s;
+  }
+  big_integer::radix r = big_integer::makeRadix(streamBase(s));
+  std::streambuf* buf = s.rdbuf();
+  typedef std::char_traits<char> traits;
+  std::ios_base::iostate state = std::ios_base::goodbit;
+  bool negative = false;
+  if (traits::eq_int_type(buf->sgetc(), traits::to_int_type('-'))) {
+    negative = true;
+    buf->sbumpc();
+  }
+  // Куски по chunk цифр складываются, как двоичный счётчик: два числа из
+  // одинакового числа кусков объединяются в одно, поэтому умножения идут
+  // на числа сравнимой длины. levels[i] -- число из 2^i кусков,
+  // powers[i] = b^(chunk * 2^i)
+  size_t const chunk = r.digits * FROM_STRING_THRESHOLD;
+  std::string digits;
+  digits.reserve(chunk);
+  vector<big_integer> levels;
+  vector<uint8_t> used;
+  vector<big_integer> powers;
+  auto power = [&](size_t level) -> big_integer const& {
+    while (powers.size() <= level) {
+      if (powers.empty()) {
+        powers.push_back(1);
+        for (size_t i = 0; i < FROM_STRING_THRESHOLD; i++) {
+          powers[0] *= r.power;
+        }
+      } else {
+        powers.push_back(powers.back() * powers.back());
+      }
+    }
+    return powers[level];
+  };
+  // high * b^(chunk * 2^level) + low
+  auto join = [&](big_integer high, big_integer const& low, size_t level) {
+    if (r.bits != 0) {
+      high <<= static_cast<int>((chunk << level) * r.bits);
+    } else {
+      high *= power(level);
+    }
+    return high + low;
+  };
+  size_t total = 0;
+  for (;;) {
+    traits::int_type c = buf->sgetc();
+    if (traits::eq_int_type(c, traits::eof())) {
+      state |= std::ios_base::eofbit;
+    } else if (digitValue(traits::to_char_type(c)) < r.base) {
+      digits.push_back(traits::to_char_type(c));
+      buf->sbumpc();
+      total++;
+      if (digits.size() < chunk) {
+        continue;
+      }
+    }
+    if (digits.size() != chunk) {
+      break;
+    }
+    big_integer cur = big_integer::readAny(r, digits.data(), chunk);
+    digits.clear();
+    size_t level = 0;
+    for (; level < levels.size() && used[level]; level++) {
+      cur = join(std::move(levels[level]), cur, level);
+      used[level] = false;
+    }
+    if (level == levels.size()) {
+      levels.push_back(big_integer());
+      used.push_back(false);
+    }
+    levels[level] = std::move(cur);
+    used[level] = true;
+  }
+  if (total == 0) {
+    s.setstate(state | std::ios_base::failbit);
+    return s;
+  }
+  // Неполный последний кусок и уровни снизу вверх: младшая часть
+  // занимает low цифр, scale = b^low
+  big_integer res;
+  big_integer scale = 1;
+  size_t low = digits.size();
+  if (low != 0) {
+    res = big_integer::readAny(r, digits.data(), low);
+    for (size_t i = 0; i < low / r.digits; i++) {
+      scale *= r.power;
+    }
+    for (size_t i = 0; i < low % r.digits; i++) {
+      scale *= r.base;
+    }
+  }
+  for (size_t level = 0; level < levels.size(); level++) {
+    if (!used[level]) {
+      continue;
+    }
+    if (low == 0) {
+      res = std::move(levels[level]);
+    } else if (r.bits != 0) {
+      res += levels[level] << static_cast<int>(low * r.bits);
+    } else {
+      res += levels[level] * scale;
+    }
+    if (r.bits == 0 && level + 1 < levels.size()) {
+      scale *= power(level);
+    }
+    low += chunk << level;
+  }
+  if (negative) {
+    res.negate();
+  }
+  res.swap(a);
+  s.setstate(state);
+  return s;
 }
 
-uint32_t big_integer::signBits() const {
-  return sign == 0 ? 0 : std::numeric_limits<uint32_t>::max();
+limb big_integer::signBits() const {
+  return sign == 0 ? 0 : std::numeric_limits<limb>::max();
 }
 
 uint8_t big_integer::leadingBit() {
-  return num.empty() ? 0 : (num.back() & (1 << (BASE - 1))) >> (BASE - 1);
+  return num.empty() ? 0 : num.back() >> (BASE - 1);
 }
 
 void big_integer::swap(big_integer& other) {
@@ -528,9 +3908,8 @@ void big_integer::swap(big_integer& other) {
 }
 
 void big_integer::setLen(size_t len) {
-  num.reserve(len);
-  while (num.size() < len) {
-    num.push_back(signBits());
+  if (num.size() < len) {
+    num.resize(len, signBits());
   }
 }
 
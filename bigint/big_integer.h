@@ -1,12 +1,41 @@
 #pragma once
 
+#include "small_vector.h"
 #include "vector.h"
+#include <charconv>
+#include <cstdint>
+#include <functional>
 #include <iosfwd>
 #include <string>
+#include <type_traits>
+
+// Разрядность limb: по умолчанию 64 там, где есть 128-битное умножение,
+// иначе 32. Можно задать явно, например -DBIGINT_LIMB_BITS=32
+#ifndef BIGINT_LIMB_BITS
+#ifdef __SIZEOF_INT128__
+#define BIGINT_LIMB_BITS 64
+#else
+#define BIGINT_LIMB_BITS 32
+#endif
+#endif
 
 struct big_integer {
+#if BIGINT_LIMB_BITS == 64
+  using limb = uint64_t;
+#else
+  using limb = uint32_t;
+#endif
+
+  // Встроенные целые до 64 бит участвуют в операциях напрямую, без
+  // построения временного big_integer
+  template <typename T>
+  using if_native = std::enable_if_t<
+      std::is_integral<T>::value && sizeof(T) <= sizeof(uint64_t), int>;
+
   big_integer();
   big_integer(big_integer const& other) = default;
+  // Перемещённый объект становится нулём
+  big_integer(big_integer&& other) noexcept;
   big_integer(int a);
   big_integer(unsigned a);
   big_integer(long unsigned a);
@@ -14,13 +43,19 @@ struct big_integer {
   big_integer(long long a);
   big_integer(long long unsigned a);
   explicit big_integer(std::string const& str);
+  // Запись по основанию base от 2 до 36 с необязательным минусом, цифры
+  // больше 9 -- буквы в любом регистре. std::invalid_argument при
+  // неверном основании или записи
+  big_integer(std::string const& str, uint32_t base);
   ~big_integer() = default;
 
   big_integer& operator=(big_integer const& other);
+  big_integer& operator=(big_integer&& other) noexcept;
 
   big_integer& operator+=(big_integer const& rhs);
   big_integer& operator-=(big_integer const& rhs);
   big_integer& operator*=(big_integer const& rhs);
+  // Деление на ноль -- std::invalid_argument, *this тогда не меняется
   big_integer& operator/=(big_integer const& rhs);
   big_integer& operator%=(big_integer const& rhs);
 
@@ -28,6 +63,40 @@ struct big_integer {
   big_integer& operator|=(big_integer const& rhs);
   big_integer& operator^=(big_integer const& rhs);
 
+  template <typename T, if_native<T> = 0>
+  big_integer& operator+=(T rhs) {
+    return addNative(native_int(rhs));
+  }
+  template <typename T, if_native<T> = 0>
+  big_integer& operator-=(T rhs) {
+    return subNative(native_int(rhs));
+  }
+  template <typename T, if_native<T> = 0>
+  big_integer& operator*=(T rhs) {
+    return mulNative(native_int(rhs));
+  }
+  template <typename T, if_native<T> = 0>
+  big_integer& operator/=(T rhs) {
+    return divRemNative(native_int(rhs), false);
+  }
+  template <typename T, if_native<T> = 0>
+  big_integer& operator%=(T rhs) {
+    return divRemNative(native_int(rhs), true);
+  }
+
+  template <typename T, if_native<T> = 0>
+  big_integer& operator&=(T rhs) {
+    return andNative(native_int(rhs));
+  }
+  template <typename T, if_native<T> = 0>
+  big_integer& operator|=(T rhs) {
+    return orNative(native_int(rhs));
+  }
+  template <typename T, if_native<T> = 0>
+  big_integer& operator^=(T rhs) {
+    return xorNative(native_int(rhs));
+  }
+
   big_integer& operator<<=(int rhs);
   big_integer& operator>>=(int rhs);
 
@@ -41,6 +110,46 @@ struct big_integer {
   big_integer& operator--();
   big_integer operator--(int);
 
+  // Разряды числа только для чтения, без копирования: дополнение до двух,
+  // little-endian, старший бит последнего разряда -- знак. Действительны,
+  // пока число не изменено
+  struct limb_view {
+    limb const* first;
+    size_t count;
+
+    limb const* data() const {
+      return first;
+    }
+    size_t size() const {
+      return count;
+    }
+    limb const* begin() const {
+      return first;
+    }
+    limb const* end() const {
+      return first + count;
+    }
+    limb operator[](size_t i) const {
+      return first[i];
+    }
+  };
+  limb_view limbs() const;
+
+  // Двоичная запись: длина в байтах (8 байт little-endian), байт знака и
+  // младшие байты дополнения до двух без старших байтов, совпадающих со
+  // знаком. Не зависит от разрядности limb
+  size_t encoded_size() const;
+  // Пишет encoded_size() байт в out и возвращает их число
+  size_t encode(unsigned char* out) const;
+  // Читает запись из начала [in, in + size) в *this и возвращает число
+  // прочитанных байт; std::invalid_argument при неполной или неверной
+  // записи, *this тогда не меняется
+  size_t decode(unsigned char const* in, size_t size);
+
+  // Хеш значения по 64-битным словам разрядов: равные числа имеют равный
+  // хеш независимо от лишних разрядов знака
+  size_t hash() const noexcept;
+
   friend bool operator==(big_integer const& a, big_integer const& b);
   friend bool operator!=(big_integer const& a, big_integer const& b);
   friend bool operator<(big_integer const& a, big_integer const& b);
@@ -48,28 +157,199 @@ struct big_integer {
   friend bool operator<=(big_integer const& a, big_integer const& b);
   friend bool operator>=(big_integer const& a, big_integer const& b);
 
+  template <typename T, if_native<T> = 0>
+  friend bool operator==(big_integer const& a, T b) {
+    return a.compareNative(native_int(b)) == 0;
+  }
+  template <typename T, if_native<T> = 0>
+  friend bool operator!=(big_integer const& a, T b) {
+    return a.compareNative(native_int(b)) != 0;
+  }
+  template <typename T, if_native<T> = 0>
+  friend bool operator<(big_integer const& a, T b) {
+    return a.compareNative(native_int(b)) < 0;
+  }
+  template <typename T, if_native<T> = 0>
+  friend bool operator>(big_integer const& a, T b) {
+    return a.compareNative(native_int(b)) > 0;
+  }
+  template <typename T, if_native<T> = 0>
+  friend bool operator<=(big_integer const& a, T b) {
+    return a.compareNative(native_int(b)) <= 0;
+  }
+  template <typename T, if_native<T> = 0>
+  friend bool operator>=(big_integer const& a, T b) {
+    return a.compareNative(native_int(b)) >= 0;
+  }
+
+  template <typename T, if_native<T> = 0>
+  friend bool operator==(T a, big_integer const& b) {
+    return b.compareNative(native_int(a)) == 0;
+  }
+  template <typename T, if_native<T> = 0>
+  friend bool operator!=(T a, big_integer const& b) {
+    return b.compareNative(native_int(a)) != 0;
+  }
+  template <typename T, if_native<T> = 0>
+  friend bool operator<(T a, big_integer const& b) {
+    return b.compareNative(native_int(a)) > 0;
+  }
+  template <typename T, if_native<T> = 0>
+  friend bool operator>(T a, big_integer const& b) {
+    return b.compareNative(native_int(a)) < 0;
+  }
+  template <typename T, if_native<T> = 0>
+  friend bool operator<=(T a, big_integer const& b) {
+    return b.compareNative(native_int(a)) >= 0;
+  }
+  template <typename T, if_native<T> = 0>
+  friend bool operator>=(T a, big_integer const& b) {
+    return b.compareNative(native_int(a)) <= 0;
+  }
+
+  // Результат пишется в буфер того операнда, у которого больше ёмкость
+  friend big_integer operator+(big_integer&& a, big_integer&& b);
+  friend big_integer operator-(big_integer&& a, big_integer&& b);
+  friend big_integer operator&(big_integer&& a, big_integer&& b);
+  friend big_integer operator|(big_integer&& a, big_integer&& b);
+  friend big_integer operator^(big_integer&& a, big_integer&& b);
+  friend big_integer operator-(big_integer const& a, big_integer&& b);
+
   friend std::string to_string(big_integer const& a);
+  friend std::string to_string(big_integer const& a, uint32_t base);
+  friend size_t to_chars_size(big_integer const& a, uint32_t base);
+  friend std::to_chars_result to_chars(char* first, char* last,
+                                       big_integer const& a, uint32_t base);
+  friend std::from_chars_result from_chars(char const* first,
+                                           char const* last,
+                                           big_integer& value, uint32_t base);
+  friend std::istream& operator>>(std::istream& s, big_integer& a);
+  friend void divmod(big_integer const& a, big_integer const& b,
+                     big_integer& quot, big_integer& rem);
+  friend big_integer powmod(big_integer const& base, big_integer const& exp,
+                            big_integer const& mod);
+  friend struct modulus_context;
+  friend struct gcd_state;
+  friend struct big_integer_batch;
+  friend big_integer and_not(big_integer const& a, big_integer const& b);
+  friend big_integer iroot(big_integer const& a, uint32_t k);
 
 private:
+  // Разрядов в 64 битах: числа такой длины хранятся без выделения памяти
+  static const size_t SMALL_LIMBS = 64 / BIGINT_LIMB_BITS;
+
   // Дополнение до двух, little-endian, старший бит должен совпадать с sign
   uint8_t sign;
-  vector<uint32_t> num;
+  small_vector<limb, SMALL_LIMBS> num;
 private:
-  big_integer& addShort(uint32_t rhs);
-  big_integer& subShort(uint32_t rhs);
-  big_integer& mulShort(uint32_t rhs);
+  // Встроенное целое: 64 младших бита в дополнении до двух и знак
+  struct native_int {
+    uint64_t bits;
+    bool negative;
+
+    template <typename T>
+    explicit native_int(T x)
+        : bits(static_cast<uint64_t>(x)), negative(x < T()) {}
+  };
+
+  big_integer& addNative(native_int rhs);
+  big_integer& subNative(native_int rhs);
+  big_integer& mulNative(native_int rhs);
+  big_integer& divRemNative(native_int rhs, bool remNeeded);
+  big_integer& andNative(native_int rhs);
+  big_integer& orNative(native_int rhs);
+  big_integer& xorNative(native_int rhs);
+  int32_t compareNative(native_int rhs) const;
+  template <typename Op>
+  void makeBinaryBitOp(native_int rhs, Op op);
+  // Младшие разряды rhs в out, возвращает значение старших разрядов
+  static limb nativeLimbs(native_int rhs, limb* out);
+  static big_integer fromNative(native_int rhs);
+
+  // Операции с числом b из m разрядов, дополненным разрядами fill
+  void addLimbsSigned(limb const* b, size_t m, limb fill);
+  void subLimbsSigned(limb const* b, size_t m, limb fill);
+  // Дописывает старший разряд результата и определяет знак
+  void pushHigh(limb high);
+  int32_t compareLimbs(limb const* b, size_t m, limb fill) const;
+  // Op -- поразрядная операция из big_integer.cpp, длинные массивы
+  // разрядов обрабатываются векторными командами
+  template <typename Op>
+  void makeBinaryBitOp(limb const* b, size_t m, limb fill, Op op);
+
+  // Значение числа, если оно помещается в int64_t. Операции над такими
+  // числами идут во встроенной арифметике с проверкой переполнения
+  bool getSmall(int64_t& value) const;
+  void setSmall(int64_t value);
+  big_integer& addShort(limb rhs);
+  big_integer& subShort(limb rhs);
+  big_integer& mulShort(limb rhs);
   big_integer& divRemLong(big_integer const& rhs, bool remNeeded);
-  uint32_t divRemShort(uint32_t rhs);
+  // Деление с отбрасыванием дробной части: частное в quot, остаток со
+  // знаком делимого в *this. quot не должен совпадать с *this и rhs
+  void divRem(big_integer const& rhs, big_integer& quot);
+  // Частное и остаток для неотрицательного *this и b > 0, выбор алгоритма
+  // по длине b: возвращает частное, в *this остаётся остаток
+  big_integer divRemMagnitude(big_integer const& b);
+  // Деление неотрицательного *this на b > 0, *this >= b: возвращает
+  // частное, в *this остаётся остаток
+  big_integer divRemSchool(big_integer const& b);
+  big_integer divRemBurnikelZiegler(big_integer b);
+  big_integer divRemNewton(big_integer b);
+  // Деление нормализованного *this по основанию B^n: divDigit(cur) делит
+  // cur < b * B^n, оставляя в нём остаток, и возвращает цифру частного
+  template <typename F>
+  big_integer divRemByBlocks(size_t n, F divDigit);
+  // Шаги Бурникеля-Циглера для b из n разрядов со старшим битом 1:
+  // *this < b * B^n и *this < b * B^(n / 2) соответственно
+  big_integer divTwoByOne(big_integer const& b, size_t n);
+  big_integer divThreeByTwo(big_integer const& b, size_t n);
+  // floor(2^(2 * BASE * n) / b) для b из n разрядов со старшим битом 1
+  static big_integer reciprocal(big_integer const& b, size_t n);
+  // Для неотрицательных чисел: число значащих разрядов и бит, число из
+  // разрядов [from, to)
+  size_t magnitudeSize() const;
+  size_t bitLength() const;
+  // Байтов в двоичной записи без старших байтов знака
+  size_t payloadBytes() const;
+  big_integer limbRange(size_t from, size_t to) const;
+  // Основание системы счисления и число его цифр в разряде
+  struct radix;
+  // std::invalid_argument для оснований вне [2, 36]
+  static radix makeRadix(uint32_t base);
+  // b^(d * 2^k), d -- число цифр, помещающихся в разряд. Степени
+  // считаются один раз на основание и хранятся до конца программы
+  static big_integer const& radixPower(radix const& r, size_t k);
+  // Записывает неотрицательное *this < b^(d * 2^(k + 1)) по основанию b в
+  // out, *powers[i] = b^(d * 2^i): с pad -- ровно d * 2^(k + 1) цифрами,
+  // иначе без ведущих нулей. Возвращает конец записи, портит *this
+  char* writeDigits(radix const& r, vector<big_integer const*> const& powers,
+                    size_t k, char* out, bool pad);
+  // Читает неотрицательное число из len > 0 цифр по основанию b,
+  // *powers[i] = b^(d * 2^i) для всех d * 2^i < len
+  static big_integer readDigits(radix const& r, char const* digits,
+                                size_t len,
+                                vector<big_integer const*> const& powers);
+  // Младшие count цифр модуля числа по основанию 2^bits в out, count не
+  // больше ceil(num.size() * BASE / bits)
+  void writeBits(uint32_t bits, char* out, size_t count) const;
+  // Неотрицательное число из len цифр по основанию 2^bits
+  static big_integer readBits(char const* digits, size_t len, uint32_t bits);
+  // Неотрицательное число из len > 0 проверенных цифр по основанию b
+  static big_integer readAny(radix const& r, char const* digits, size_t len);
+  // Число бит модуля, в том числе для отрицательных чисел
+  size_t magnitudeBits() const;
+  limb divRemShort(limb rhs);
   int32_t compareTo(big_integer const& other) const;
   int32_t normalize();
   void swap(big_integer& other);
   void invert();
   void negate();
 
-  template<typename F>
-  void makeBinaryBitOp(big_integer const& rhs, F func);
+  template <typename Op>
+  void makeBinaryBitOp(big_integer const& rhs, Op op);
 
-  uint32_t signBits() const;
+  limb signBits() const;
   uint8_t leadingBit();
   void fixLeadingBits();
   void pushBits(uint64_t a);
@@ -86,6 +366,102 @@ big_integer operator&(big_integer a, big_integer const& b);
 big_integer operator|(big_integer a, big_integer const& b);
 big_integer operator^(big_integer a, big_integer const& b);
 
+// Временный правый операнд используется как буфер результата. У
+// умножения таких перегрузок нет: произведение не пишется поверх
+// множителей и всё равно получает свой буфер
+big_integer operator+(big_integer const& a, big_integer&& b);
+big_integer operator-(big_integer const& a, big_integer&& b);
+big_integer operator&(big_integer const& a, big_integer&& b);
+big_integer operator|(big_integer const& a, big_integer&& b);
+big_integer operator^(big_integer const& a, big_integer&& b);
+
+big_integer operator+(big_integer&& a, big_integer&& b);
+big_integer operator-(big_integer&& a, big_integer&& b);
+big_integer operator&(big_integer&& a, big_integer&& b);
+big_integer operator|(big_integer&& a, big_integer&& b);
+big_integer operator^(big_integer&& a, big_integer&& b);
+
+// a & ~b без построения ~b
+big_integer and_not(big_integer const& a, big_integer const& b);
+
+template <typename T, big_integer::if_native<T> = 0>
+big_integer operator+(big_integer a, T b) {
+  a += b;
+  return a;
+}
+
+template <typename T, big_integer::if_native<T> = 0>
+big_integer operator+(T a, big_integer b) {
+  b += a;
+  return b;
+}
+
+template <typename T, big_integer::if_native<T> = 0>
+big_integer operator-(big_integer a, T b) {
+  a -= b;
+  return a;
+}
+
+template <typename T, big_integer::if_native<T> = 0>
+big_integer operator*(big_integer a, T b) {
+  a *= b;
+  return a;
+}
+
+template <typename T, big_integer::if_native<T> = 0>
+big_integer operator*(T a, big_integer b) {
+  b *= a;
+  return b;
+}
+
+template <typename T, big_integer::if_native<T> = 0>
+big_integer operator/(big_integer a, T b) {
+  a /= b;
+  return a;
+}
+
+template <typename T, big_integer::if_native<T> = 0>
+big_integer operator%(big_integer a, T b) {
+  a %= b;
+  return a;
+}
+
+template <typename T, big_integer::if_native<T> = 0>
+big_integer operator&(big_integer a, T b) {
+  a &= b;
+  return a;
+}
+
+template <typename T, big_integer::if_native<T> = 0>
+big_integer operator&(T a, big_integer b) {
+  b &= a;
+  return b;
+}
+
+template <typename T, big_integer::if_native<T> = 0>
+big_integer operator|(big_integer a, T b) {
+  a |= b;
+  return a;
+}
+
+template <typename T, big_integer::if_native<T> = 0>
+big_integer operator|(T a, big_integer b) {
+  b |= a;
+  return b;
+}
+
+template <typename T, big_integer::if_native<T> = 0>
+big_integer operator^(big_integer a, T b) {
+  a ^= b;
+  return a;
+}
+
+template <typename T, big_integer::if_native<T> = 0>
+big_integer operator^(T a, big_integer b) {
+  b ^= a;
+  return b;
+}
+
 big_integer operator<<(big_integer a, int b);
 big_integer operator>>(big_integer a, int b);
 
@@ -96,5 +472,186 @@ bool operator>(big_integer const& a, big_integer const& b);
 bool operator<=(big_integer const& a, big_integer const& b);
 bool operator>=(big_integer const& a, big_integer const& b);
 
+// Частное и остаток одного деления
+struct big_integer_divmod {
+  big_integer quot;
+  big_integer rem;
+};
+
+// a == quot * b + rem. divmod округляет частное к нулю, остаток со знаком
+// a, как операторы / и %. divmod_floor округляет вниз, остаток со знаком b.
+// Варианты с quot и rem пишут результат в переданные объекты, которые
+// могут совпадать с a и b, но не друг с другом. std::invalid_argument при
+// b == 0 и quot, совпадающем с rem
+big_integer_divmod divmod(big_integer const& a, big_integer const& b);
+big_integer_divmod divmod_floor(big_integer const& a, big_integer const& b);
+void divmod(big_integer const& a, big_integer const& b, big_integer& quot,
+            big_integer& rem);
+void divmod_floor(big_integer const& a, big_integer const& b,
+                  big_integer& quot, big_integer& rem);
+
+// base^exp mod mod в [0, mod) для exp >= 0 и mod > 0, иначе
+// std::invalid_argument. Нечётный модуль -- умножение Монтгомери и
+// скользящее окно, чётный -- возведение в квадрат с делением
+big_integer powmod(big_integer const& base, big_integer const& exp,
+                   big_integer const& mod);
+
+// Приведение по фиксированному модулю m > 0 методом Барретта: обратное
+// к m считается один раз, дальше каждое приведение -- старшая половина
+// одного произведения и младшая другого, без деления. Рабочий буфер
+// хранится в контексте, поэтому один контекст не используется из
+// нескольких потоков одновременно
+struct modulus_context {
+  // std::invalid_argument, если mod <= 0
+  explicit modulus_context(big_integer const& mod);
+
+  big_integer const& modulus() const;
+  // a mod m в [0, m) для любого a
+  big_integer reduce(big_integer const& a) const;
+  big_integer mulmod(big_integer const& a, big_integer const& b) const;
+  // a и b из [0, m)
+  big_integer addmod(big_integer const& a, big_integer const& b) const;
+  big_integer submod(big_integer const& a, big_integer const& b) const;
+
+private:
+  // y[0, 2n) < m' * B^n заменяется на y mod m', scratch -- blockScratch()
+  // разрядов
+  void reduceBlock(big_integer::limb* y, big_integer::limb* scratch) const;
+  size_t blockScratch() const;
+
+  big_integer mod;
+  // m' = m * 2^shift со старшим битом 1 в старшем из n разрядов
+  big_integer norm;
+  uint32_t shift;
+  size_t n;
+  // min(floor(B^(2n) / m') - B^n, B^n - 1), n разрядов
+  big_integer inv;
+  mutable vector<big_integer::limb> buffer;
+};
+
+// Наибольший общий делитель |a| и |b|, gcd(0, 0) = 0. Шаги Лемера по
+// старшим разрядам, для длинных чисел -- половинный НОД
+big_integer gcd(big_integer const& a, big_integer const& b);
+// gcd(a, b) == a * x + b * y, x и y могут совпадать с a и b
+big_integer gcd_ext(big_integer const& a, big_integer const& b,
+                    big_integer& x, big_integer& y);
+// Обратный к a по модулю m в [0, m). std::invalid_argument, если m <= 0
+// или a не взаимно просто с m
+big_integer modinv(big_integer const& a, big_integer const& m);
+
+// floor(a^(1/k)), для отрицательного a при нечётном k -- -iroot(-a, k).
+// std::invalid_argument при k == 0 и при чётном k для a < 0. Итерации
+// Ньютона с точностью, удваивающейся от оценки по старшим битам
+big_integer iroot(big_integer const& a, uint32_t k);
+// floor(sqrt(a)) для a >= 0, иначе std::invalid_argument
+big_integer isqrt(big_integer const& a);
+
 std::string to_string(big_integer const& a);
+// Запись по основанию base от 2 до 36 строчными буквами, иначе
+// std::invalid_argument. Для степеней двойки -- за линейное время по битам
+std::string to_string(big_integer const& a, uint32_t base);
+// Число потоков умножения: с threads > 1 преобразование Фурье для
+// множителей от BIGINT_PARALLEL_THRESHOLD разрядов делится между потоками.
+// 0 -- по числу ядер, по умолчанию 1 (последовательно): выигрыш зависит
+// от числа ядер, а на одном ядре потоки только добавляют накладные
+// расходы. Задачи берутся потоками из общей очереди, без перехвата.
+// Нельзя вызывать, пока в других потоках идут умножения
+void set_multiplication_threads(size_t threads);
+size_t multiplication_threads();
+
+// Верхняя оценка числа символов записи по основанию base, для степеней
+// двойки точная
+size_t to_chars_size(big_integer const& a, uint32_t base = 10);
+// Запись по основанию base в [first, last) без завершающего нуля, как
+// std::to_chars: {last, std::errc::value_too_large}, если не поместилась.
+// Буфера из to_chars_size символов всегда достаточно
+std::to_chars_result to_chars(char* first, char* last, big_integer const& a,
+                              uint32_t base = 10);
+// Разбирает необязательный минус и наибольший префикс из цифр по
+// основанию base, как std::from_chars: ptr -- первый неразобранный символ,
+// {first, std::errc::invalid_argument} без цифр, value тогда не меняется
+std::from_chars_result from_chars(char const* first, char const* last,
+                                  big_integer& value, uint32_t base = 10);
+// Основание записи по флагам потока: std::hex, std::oct или десятичное.
+// Раньше вывод был всегда десятичным, showbase и uppercase не учитываются
 std::ostream& operator<<(std::ostream& s, big_integer const& a);
+// Пропускает пробелы и читает число кусками, не собирая запись в строку.
+// Основание по флагам потока, без цифр -- failbit и a не меняется
+std::istream& operator>>(std::istream& s, big_integer& a);
+
+// Число вместе с посчитанным один раз хешем -- ключ для повторных поисков
+// в хеш-таблицах. Сравнение сначала по хешу, потом по значению
+struct hashed_big_integer {
+  explicit hashed_big_integer(big_integer value);
+
+  big_integer const& value() const;
+  size_t hash() const;
+
+  friend bool operator==(hashed_big_integer const& a,
+                         hashed_big_integer const& b);
+  friend bool operator!=(hashed_big_integer const& a,
+                         hashed_big_integer const& b);
+
+private:
+  big_integer val;
+  size_t hash_;
+};
+
+// Набор из lanes чисел одной ширины width разрядов в дополнении до двух,
+// разложенных по столбцам: разряд 0 всех чисел подряд, затем разряд 1 и
+// так далее. Операции над наборами проходят столбец всех чисел одним
+// циклом, без выделений памяти и ветвлений на каждое число
+struct big_integer_batch {
+  using limb = big_integer::limb;
+
+  // Все числа -- нули. std::invalid_argument при width == 0
+  big_integer_batch(size_t lanes, size_t width);
+
+  size_t lanes() const;
+  size_t width() const;
+  // Разряд k всех чисел, lanes подряд
+  limb* column(size_t k);
+  limb const* column(size_t k) const;
+
+  big_integer get(size_t lane) const;
+  // std::invalid_argument, если a не помещается в width разрядов
+  void set(size_t lane, big_integer const& a);
+
+private:
+  size_t lanes_;
+  size_t width_;
+  vector<limb> data;
+};
+
+// Операции над числами с одинаковыми номерами в наборах с одинаковым
+// числом чисел, иначе std::invalid_argument. Более узкие операнды
+// расширяются знаком, результат берётся по модулю ширины res, как у
+// встроенных целых: точная сумма помещается в max(wa, wb) + 1 разрядов,
+// произведение -- в wa + wb. res может совпадать с a и b
+void add(big_integer_batch& res, big_integer_batch const& a,
+         big_integer_batch const& b);
+void sub(big_integer_batch& res, big_integer_batch const& a,
+         big_integer_batch const& b);
+// Длинные числа, от десятка разрядов, умножаются по одному: умножение по
+// столбцам квадратично и там уже не быстрее operator*
+void mul(big_integer_batch& res, big_integer_batch const& a,
+         big_integer_batch const& b);
+// res[i] -- знак a[i] - b[i]: -1, 0 или 1; res из lanes элементов
+void compare(big_integer_batch const& a, big_integer_batch const& b,
+             int32_t* res);
+
+namespace std {
+template <>
+struct hash<big_integer> {
+  size_t operator()(big_integer const& a) const noexcept {
+    return a.hash();
+  }
+};
+
+template <>
+struct hash<hashed_big_integer> {
+  size_t operator()(hashed_big_integer const& a) const noexcept {
+    return a.hash();
+  }
+};
+} // namespace std
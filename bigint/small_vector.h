@@ -0,0 +1,218 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+// Вектор тривиально копируемых элементов, первые SMALL_SIZE из которых
+// хранятся в самом объекте без выделения памяти
+template <typename T, size_t SMALL_SIZE>
+struct small_vector {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "small_vector copies elements bytewise");
+  static_assert(SMALL_SIZE > 0, "small_vector needs inline storage");
+
+  using iterator = T*;
+  using const_iterator = T const*;
+
+  // O(1) nothrow
+  small_vector() : size_(0), capacity_(SMALL_SIZE) {}
+
+  // O(N) strong
+  small_vector(small_vector const& other)
+      : size_(other.size_), capacity_(SMALL_SIZE) {
+    if (size_ > SMALL_SIZE) {
+      dyn_data_ = allocate(size_);
+      capacity_ = size_;
+    }
+    std::memcpy(data(), other.data(), size_ * sizeof(T));
+  }
+
+  // O(1) nothrow
+  small_vector(small_vector&& other) noexcept
+      : size_(other.size_), capacity_(other.capacity_) {
+    if (other.is_static()) {
+      std::memcpy(stat_data_, other.stat_data_, size_ * sizeof(T));
+    } else {
+      dyn_data_ = other.dyn_data_;
+    }
+    other.size_ = 0;
+    other.capacity_ = SMALL_SIZE;
+  }
+
+  // O(N) strong
+  small_vector& operator=(small_vector const& other) {
+    if (&other != this) {
+      small_vector(other).swap(*this);
+    }
+    return *this;
+  }
+
+  // O(1) nothrow
+  small_vector& operator=(small_vector&& other) noexcept {
+    if (&other != this) {
+      small_vector(std::move(other)).swap(*this);
+    }
+    return *this;
+  }
+
+  // O(1) nothrow
+  ~small_vector() {
+    if (!is_static()) {
+      operator delete(dyn_data_);
+    }
+  }
+
+  bool operator==(small_vector const& other) const {
+    return size_ == other.size_ &&
+           std::equal(begin(), end(), other.begin());
+  }
+
+  // O(1) nothrow
+  T& operator[](size_t i) {
+    return data()[i];
+  }
+
+  // O(1) nothrow
+  T const& operator[](size_t i) const {
+    return data()[i];
+  }
+
+  // O(1) nothrow
+  T* data() {
+    return is_static() ? stat_data_ : dyn_data_;
+  }
+
+  // O(1) nothrow
+  T const* data() const {
+    return is_static() ? stat_data_ : dyn_data_;
+  }
+
+  // O(1) nothrow
+  size_t size() const {
+    return size_;
+  }
+
+  // O(1) nothrow
+  T& back() {
+    return data()[size_ - 1];
+  }
+
+  // O(1) nothrow
+  T const& back() const {
+    return data()[size_ - 1];
+  }
+
+  // O(1)* strong
+  void push_back(T const& element) {
+    if (size_ == capacity_) {
+      T copy = element;
+      change_capacity(2 * capacity_ + 1);
+      data()[size_++] = copy;
+    } else {
+      data()[size_++] = element;
+    }
+  }
+
+  // O(1) nothrow
+  void pop_back() {
+    size_--;
+  }
+
+  // O(1) nothrow
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  // O(1) nothrow
+  size_t capacity() const {
+    return capacity_;
+  }
+
+  // O(N) strong
+  void reserve(size_t n) {
+    if (n > capacity_) {
+      change_capacity(n);
+    }
+  }
+
+  // O(N) strong
+  void resize(size_t n, T const& value) {
+    if (n > capacity_) {
+      T copy = value;
+      change_capacity(n);
+      std::fill(data() + size_, data() + n, copy);
+    } else if (n > size_) {
+      std::fill(data() + size_, data() + n, value);
+    }
+    size_ = n;
+  }
+
+  // O(1) nothrow
+  void clear() {
+    size_ = 0;
+  }
+
+  // O(1) nothrow
+  void swap(small_vector& other) {
+    std::swap(size_, other.size_);
+    std::swap(capacity_, other.capacity_);
+    // Элементы тривиально копируемы, поэтому объединение меняется побайтно
+    unsigned char temp[sizeof(storage_)];
+    std::memcpy(temp, storage_, sizeof(storage_));
+    std::memcpy(storage_, other.storage_, sizeof(storage_));
+    std::memcpy(other.storage_, temp, sizeof(storage_));
+  }
+
+  // O(1) nothrow
+  iterator begin() {
+    return data();
+  }
+
+  // O(1) nothrow
+  iterator end() {
+    return data() + size_;
+  }
+
+  // O(1) nothrow
+  const_iterator begin() const {
+    return data();
+  }
+
+  // O(1) nothrow
+  const_iterator end() const {
+    return data() + size_;
+  }
+
+private:
+  bool is_static() const {
+    return capacity_ == SMALL_SIZE;
+  }
+
+  static T* allocate(size_t n) {
+    return static_cast<T*>(operator new(n * sizeof(T)));
+  }
+
+  void change_capacity(size_t new_capacity) {
+    T* temp = allocate(new_capacity);
+    std::memcpy(temp, data(), size_ * sizeof(T));
+    if (!is_static()) {
+      operator delete(dyn_data_);
+    }
+    dyn_data_ = temp;
+    capacity_ = new_capacity;
+  }
+
+private:
+  size_t size_;
+  // SMALL_SIZE, пока элементы лежат в stat_data_, иначе размер буфера
+  size_t capacity_;
+  union {
+    T stat_data_[SMALL_SIZE];
+    T* dyn_data_;
+    unsigned char storage_[sizeof(T) * SMALL_SIZE > sizeof(T*)
+                               ? sizeof(T) * SMALL_SIZE
+                               : sizeof(T*)];
+  };
+};
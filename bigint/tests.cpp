@@ -2,8 +2,15 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <iomanip>
 #include <limits>
+#include <random>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "big_integer.h"
 
@@ -85,6 +92,92 @@ TEST(correctness, assignment_return_value) {
   EXPECT_TRUE(b == 7);
 }
 
+TEST(correctness, move_ctor) {
+  big_integer a("-123456789012345678901234567890");
+  big_integer b = std::move(a);
+
+  EXPECT_EQ(b, big_integer("-123456789012345678901234567890"));
+  EXPECT_EQ(a, 0);
+  a += 5;
+  EXPECT_EQ(a, 5);
+}
+
+TEST(correctness, move_assignment) {
+  big_integer a("-123456789012345678901234567890");
+  big_integer b = 7;
+  b = std::move(a);
+
+  EXPECT_EQ(b, big_integer("-123456789012345678901234567890"));
+  EXPECT_EQ(a, 0);
+  b = std::move(b);
+  EXPECT_EQ(b, big_integer("-123456789012345678901234567890"));
+}
+
+TEST(correctness, rvalue_operators) {
+  big_integer a("123456789012345678901234567890");
+  big_integer b("-98765432109876543210");
+  big_integer big = a << 1000;
+  for (big_integer const* x : {&a, &b, &big}) {
+    for (big_integer const* y : {&a, &b, &big}) {
+      EXPECT_EQ(*x + *y, big_integer(*x) + big_integer(*y));
+      EXPECT_EQ(*x + *y, *x + big_integer(*y));
+      EXPECT_EQ(*x - *y, big_integer(*x) - big_integer(*y));
+      EXPECT_EQ(*x - *y, *x - big_integer(*y));
+      EXPECT_EQ(*x * *y, big_integer(*x) * big_integer(*y));
+      EXPECT_EQ(*x * *y, *x * big_integer(*y));
+      EXPECT_EQ(*x & *y, big_integer(*x) & big_integer(*y));
+      EXPECT_EQ(*x & *y, *x & big_integer(*y));
+      EXPECT_EQ(*x | *y, big_integer(*x) | big_integer(*y));
+      EXPECT_EQ(*x | *y, *x | big_integer(*y));
+      EXPECT_EQ(*x ^ *y, big_integer(*x) ^ big_integer(*y));
+      EXPECT_EQ(*x ^ *y, *x ^ big_integer(*y));
+    }
+  }
+}
+
+TEST(correctness, rvalue_operators_reuse_buffer) {
+  big_integer narrow("123456789012345678901234567890");
+  for (int order = 0; order < 2; order++) {
+    for (int op = 0; op < 5; op++) {
+      // Сдвиг вправо оставляет запас ёмкости, результат помещается в буфер
+      big_integer a = (narrow << 2000) >> 1000;
+      big_integer b = narrow;
+      big_integer const* big = &a;
+      if (order != 0) {
+        std::swap(a, b);
+        big = &b;
+      }
+      big_integer expected;
+      big_integer result;
+      big_integer::limb const* buffer = big->limbs().data();
+      switch (op) {
+        case 0:
+          expected = a + b;
+          result = std::move(a) + std::move(b);
+          break;
+        case 1:
+          expected = a - b;
+          result = std::move(a) - std::move(b);
+          break;
+        case 2:
+          expected = a & b;
+          result = std::move(a) & std::move(b);
+          break;
+        case 3:
+          expected = a | b;
+          result = std::move(a) | std::move(b);
+          break;
+        default:
+          expected = a ^ b;
+          result = std::move(a) ^ std::move(b);
+          break;
+      }
+      EXPECT_EQ(result, expected);
+      EXPECT_EQ(result.limbs().data(), buffer);
+    }
+  }
+}
+
 TEST(correctness, comparisons) {
   big_integer a = 100;
   big_integer b = 100;
@@ -455,6 +548,80 @@ TEST(correctness, shr_return_value) {
   EXPECT_EQ(8, a);
 }
 
+TEST(correctness, small_overflow) {
+  big_integer max = std::numeric_limits<int64_t>::max();
+  big_integer min = std::numeric_limits<int64_t>::min();
+
+  EXPECT_EQ(max + 1, big_integer("9223372036854775808"));
+  EXPECT_EQ(min - 1, big_integer("-9223372036854775809"));
+  EXPECT_EQ(max - min, big_integer("18446744073709551615"));
+  EXPECT_EQ(min * -1, big_integer("9223372036854775808"));
+  EXPECT_EQ(max * max, big_integer("85070591730234615847396907784232501249"));
+  EXPECT_EQ(min / -1, big_integer("9223372036854775808"));
+  EXPECT_EQ(min % -1, 0);
+  EXPECT_EQ(-min, big_integer("9223372036854775808"));
+  EXPECT_EQ(max << 1, big_integer("18446744073709551614"));
+  EXPECT_EQ(big_integer(1) << 63, big_integer("9223372036854775808"));
+  EXPECT_EQ(big_integer(-1) << 63, min);
+  EXPECT_EQ(big_integer(-1) << 64, big_integer("-18446744073709551616"));
+  EXPECT_EQ(min >> 100, -1);
+  EXPECT_EQ(max >> 100, 0);
+
+  big_integer a = max;
+  EXPECT_EQ(++a, big_integer("9223372036854775808"));
+  EXPECT_EQ(--a, max);
+  a = min;
+  EXPECT_EQ(--a, big_integer("-9223372036854775809"));
+  EXPECT_EQ(++a, min);
+  EXPECT_EQ((a + a) / 2, min);
+}
+
+namespace {
+template <typename T>
+void test_native_operand(big_integer const& a, T n) {
+  big_integer b = n;
+  EXPECT_EQ(a + b, a + n);
+  EXPECT_EQ(a + b, n + a);
+  EXPECT_EQ(a - b, a - n);
+  EXPECT_EQ(a * b, a * n);
+  EXPECT_EQ(a * b, n * a);
+  if (n != 0) {
+    EXPECT_EQ(a / b, a / n);
+    EXPECT_EQ(a % b, a % n);
+  }
+  EXPECT_EQ(a & b, a & n);
+  EXPECT_EQ(a | b, n | a);
+  EXPECT_EQ(a ^ b, a ^ n);
+  EXPECT_EQ(a == b, a == n);
+  EXPECT_EQ(a != b, n != a);
+  EXPECT_EQ(a < b, a < n);
+  EXPECT_EQ(a < b, n > a);
+  EXPECT_EQ(a >= b, a >= n);
+  EXPECT_EQ(a >= b, n <= a);
+}
+} // namespace
+
+TEST(correctness, native_operands) {
+  big_integer big("123456789012345678901234567890123456789");
+  std::vector<big_integer> values = {0, 1, -1, 7, -7, big, -big};
+  values.push_back(std::numeric_limits<int64_t>::max());
+  values.push_back(std::numeric_limits<int64_t>::min());
+  values.push_back(std::numeric_limits<uint64_t>::max());
+  values.push_back(big_integer(std::numeric_limits<uint64_t>::max()) + 1);
+  for (big_integer const& a : values) {
+    test_native_operand(a, 0);
+    test_native_operand(a, -3);
+    test_native_operand(a, 10u);
+    test_native_operand(a, static_cast<short>(-5));
+    test_native_operand(a, std::numeric_limits<int>::min());
+    test_native_operand(a, std::numeric_limits<int64_t>::min());
+    test_native_operand(a, std::numeric_limits<int64_t>::max());
+    test_native_operand(a, std::numeric_limits<uint64_t>::max());
+    test_native_operand(a, uint64_t(1) << 63);
+    test_native_operand(a, (uint64_t(1) << 32) + 1);
+  }
+}
+
 TEST(correctness, add_long) {
   big_integer a("10000000000000000000000000000000000000000000000000000000000000"
                 "000000000000000000000000000000");
@@ -551,6 +718,176 @@ TEST(correctness, mul_long_pow2) {
   EXPECT_EQ(c, b * b);
 }
 
+namespace {
+big_integer random_unsigned(std::mt19937& rng, size_t limbs) {
+  if (limbs == 1) {
+    return static_cast<uint32_t>(rng());
+  }
+  size_t half = limbs / 2;
+  return (random_unsigned(rng, limbs - half) << (32 * half)) +
+         random_unsigned(rng, half);
+}
+
+big_integer random_big_integer(std::mt19937& rng, size_t limbs) {
+  big_integer res = random_unsigned(rng, limbs);
+  return (rng() % 2 == 0) ? res : -res;
+}
+
+// a * b для 0 <= a < 2^bits, где bits кратно 512: a режется пополам до
+// кусков по 512 бит, каждый кусок умножается в столбик
+big_integer mul_by_parts(big_integer const& a, big_integer const& b,
+                         int bits) {
+  if (bits == 512) {
+    return a * b;
+  }
+  int half = bits / 1024 * 512;
+  big_integer high = a >> half;
+  big_integer low = a - (high << half);
+  return (mul_by_parts(high, b, bits - half) << half) +
+         mul_by_parts(low, b, half);
+}
+
+big_integer mul_by_parts(big_integer a, big_integer const& b) {
+  bool negative = a < 0;
+  if (negative) {
+    a = -a;
+  }
+  int bits = 512;
+  while ((a >> bits) != 0) {
+    bits *= 2;
+  }
+  big_integer res = mul_by_parts(a, b, bits);
+  return negative ? -res : res;
+}
+} // namespace
+
+TEST(correctness, mul_karatsuba_nines) {
+  std::string nines(2000, '9');
+  std::string expected = std::string(1999, '9') + "8" +
+                         std::string(1999, '0') + "1";
+  big_integer a(nines);
+
+  EXPECT_EQ(expected, to_string(a * a));
+  EXPECT_EQ(expected, to_string(-a * -a));
+  EXPECT_EQ("-" + expected, to_string(a * -a));
+}
+
+TEST(correctness, mul_karatsuba_random) {
+  std::mt19937 rng(12345);
+  for (size_t n : {31, 32, 33, 64, 100, 257, 600}) {
+    for (size_t m : {1, 17, 32, 63, 200, 500}) {
+      big_integer a = random_big_integer(rng, n);
+      big_integer b = random_big_integer(rng, m);
+      EXPECT_EQ(mul_by_parts(a, b), a * b);
+      EXPECT_EQ(mul_by_parts(b, a), b * a);
+    }
+  }
+}
+
+TEST(correctness, mul_toom3_random) {
+  std::mt19937 rng(54321);
+  for (size_t n : {128, 200, 385, 1000, 2500}) {
+    for (size_t m : {128, 190, 384, 700, 2400}) {
+      big_integer a = random_big_integer(rng, n);
+      big_integer b = random_big_integer(rng, m);
+      EXPECT_EQ(mul_by_parts(a, b), a * b);
+    }
+  }
+}
+
+TEST(correctness, mul_toom3_all_ones) {
+  for (int bits : {32 * 300, 32 * 300 + 17, 32 * 1000}) {
+    big_integer a = (big_integer(1) << bits) - 1;
+    big_integer b = (big_integer(1) << (bits - 100)) - 1;
+    EXPECT_EQ(mul_by_parts(a, b), a * b);
+    EXPECT_EQ(mul_by_parts(a, a), a * a);
+    EXPECT_EQ(mul_by_parts(-a, b), -a * b);
+  }
+}
+
+TEST(correctness, mul_ntt_random) {
+  std::mt19937 rng(777);
+  for (auto [n, m] : {std::pair{2048, 2048}, {3001, 2500}, {6000, 2100}}) {
+    big_integer a = random_big_integer(rng, n);
+    big_integer b = random_big_integer(rng, m);
+    EXPECT_EQ(mul_by_parts(a, b), a * b);
+  }
+}
+
+TEST(correctness, mul_ntt_all_ones) {
+  // Все разряды максимальны -- самые большие коэффициенты свёртки
+  big_integer a = (big_integer(1) << (32 * 4100)) - 1;
+  big_integer b = (big_integer(1) << (32 * 2500 + 5)) - 1;
+  EXPECT_EQ(mul_by_parts(a, b), a * b);
+  EXPECT_EQ(mul_by_parts(b, -a), b * -a);
+}
+
+TEST(correctness, mul_parallel) {
+  // Множители длиннее порога деления преобразования между потоками
+  std::mt19937 rng(8128);
+  big_integer a = random_big_integer(rng, 140000);
+  big_integer b = random_big_integer(rng, 70001);
+  big_integer ones = (big_integer(1) << (32 * 70000)) - 1;
+  big_integer ab = a * b;
+  big_integer aa = a * a;
+  big_integer ob = ones * -b;
+
+  set_multiplication_threads(4);
+  EXPECT_EQ(4u, multiplication_threads());
+  EXPECT_EQ(ab, a * b);
+  EXPECT_EQ(aa, a * a);
+  EXPECT_EQ(ob, ones * -b);
+
+  // Умножения из нескольких потоков идут через общий пул
+  std::vector<big_integer> results(3);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < results.size(); i++) {
+    threads.emplace_back([&, i] { results[i] = i == 1 ? a * a : a * b; });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(ab, results[0]);
+  EXPECT_EQ(aa, results[1]);
+  EXPECT_EQ(ab, results[2]);
+
+  set_multiplication_threads(1);
+  EXPECT_EQ(1u, multiplication_threads());
+  EXPECT_EQ(ab, a * b);
+}
+
+TEST(correctness, mul_square) {
+  std::mt19937 rng(4242);
+  for (size_t n : {1, 5, 31, 32, 100, 127, 128, 500, 2047, 2048, 3000}) {
+    big_integer a = random_big_integer(rng, n);
+    big_integer copy = a;
+    big_integer expected = mul_by_parts(a, a);
+    EXPECT_EQ(expected, a * a);
+    EXPECT_EQ(expected, a * copy);
+    a *= a;
+    EXPECT_EQ(expected, a);
+  }
+}
+
+TEST(correctness, mul_square_zero) {
+  big_integer a;
+  EXPECT_EQ(0, a * a);
+  a *= a;
+  EXPECT_EQ(0, a);
+}
+
+TEST(correctness, mul_square_all_ones) {
+  for (int bits : {32 * 20, 32 * 40, 32 * 200 + 1, 32 * 2100}) {
+    big_integer a = (big_integer(1) << bits) - 1;
+    big_integer expected = (big_integer(1) << (2 * bits)) -
+                           (big_integer(1) << (bits + 1)) + 1;
+    EXPECT_EQ(expected, a * a);
+    a = -a;
+    a *= a;
+    EXPECT_EQ(expected, a);
+  }
+}
+
 TEST(correctness, div_long) {
   big_integer a("10000000000000000000000000000000000000000000000000000000000000"
                 "000000000000000000000000000000");
@@ -578,6 +915,424 @@ TEST(correctness, div_long_signed2) {
   EXPECT_EQ(c, a / b);
 }
 
+namespace {
+void test_division(big_integer const& a, big_integer const& b) {
+  big_integer q = a / b;
+  big_integer r = a % b;
+  EXPECT_EQ(a, q * b + r);
+  EXPECT_TRUE(r == 0 || (r < 0) == (a < 0));
+  EXPECT_TRUE((r < 0 ? -r : r) < (b < 0 ? -b : b));
+}
+} // namespace
+
+TEST(correctness, div_long_random) {
+  std::mt19937 rng(31337);
+  for (auto [n, m] : {std::pair{130, 64}, {129, 65}, {200, 100}, {1000, 70},
+                      {1000, 400}, {5000, 2600}, {300, 299}}) {
+    big_integer a = random_big_integer(rng, n);
+    big_integer b = random_big_integer(rng, m);
+    test_division(a, b);
+    test_division(a, b + 1);
+  }
+}
+
+TEST(correctness, div_burnikel_ziegler_random) {
+  std::mt19937 rng(1729);
+  for (auto [n, m] : {std::pair{32, 16}, {40, 17}, {100, 33}, {1000, 100},
+                      {511, 255}, {2000, 1023}, {700, 500}}) {
+    big_integer a = random_big_integer(rng, n);
+    big_integer b = random_big_integer(rng, m);
+    test_division(a, b);
+    test_division(a, (b >> 1) + 1);
+  }
+}
+
+TEST(correctness, div_newton) {
+  // Делитель от 65536 разрядов при любой их ширине -- деление через
+  // обратное по Ньютону с рекурсивным вычислением обратного. Частное и
+  // остаток -- одним делением, оно здесь дорогое
+  std::mt19937 rng(65537);
+  size_t m = 2 * 65536 + 3;
+  big_integer b = random_unsigned(rng, m);
+  big_integer a = random_unsigned(rng, 2 * m - 5);
+  big_integer_divmod res = divmod(a, b);
+  EXPECT_EQ(a, res.quot * b + res.rem);
+  EXPECT_TRUE(res.rem >= 0 && res.rem < b);
+  // Делитель из одних единиц и наибольший остаток
+  big_integer ones = (big_integer(1) << (32 * m)) - 1;
+  res = divmod(ones * ones - 1, ones);
+  EXPECT_EQ(ones - 1, res.quot);
+  EXPECT_EQ(ones - 1, res.rem);
+}
+
+TEST(correctness, div_long_edge) {
+  for (int bits : {64 * 32, 64 * 32 + 1, 100 * 32 - 1, 700 * 32}) {
+    big_integer b = (big_integer(1) << bits) - 1;
+    big_integer a = b * b;
+    EXPECT_EQ(b, a / b);
+    EXPECT_EQ(0, a % b);
+    EXPECT_EQ(b - 1, (a - 1) / b);
+    EXPECT_EQ(b - 1, (a - 1) % b);
+    EXPECT_EQ(b + 1, (a + 2 * b + 1) / (b + 1));
+    EXPECT_EQ(-b, a / -b);
+    test_division(-a + 12345, b);
+  }
+}
+
+TEST(correctness, div_school_corrections) {
+  // Разряды 0, 1, 2^31 и 2^32 - 1 чаще всего дают завышенную оценку
+  // цифры частного и совпадение старших разрядов делимого и делителя
+  uint32_t const words[] = {0, 1, 0x80000000u, 0xFFFFFFFFu};
+  std::mt19937 rng(4242);
+  for (int i = 0; i < 3000; i++) {
+    big_integer a;
+    big_integer b;
+    for (size_t j = 0, n = 4 + rng() % 16; j < n; j++) {
+      a = (a << 32) + words[rng() % 4];
+    }
+    for (size_t j = 0, m = 2 + rng() % 8; j < m; j++) {
+      b = (b << 32) + words[rng() % 4];
+    }
+    if (b == 0) {
+      continue;
+    }
+    test_division(a, b);
+    test_division(b * ((big_integer(1) << 256) - 1) + (b - 1), b);
+    test_division(-a, b);
+  }
+}
+
+TEST(correctness, divmod) {
+  std::mt19937 rng(2718);
+  for (auto [n, m] : {std::pair{1, 1}, {2, 1}, {3, 2}, {100, 40}, {700, 400}}) {
+    for (int signs = 0; signs < 4; signs++) {
+      big_integer a = random_big_integer(rng, n);
+      big_integer b = random_big_integer(rng, m) + 1;
+      a = signs & 1 ? -a : a;
+      b = signs & 2 ? -b : b;
+
+      big_integer_divmod t = divmod(a, b);
+      EXPECT_EQ(a / b, t.quot);
+      EXPECT_EQ(a % b, t.rem);
+
+      big_integer_divmod f = divmod_floor(a, b);
+      EXPECT_EQ(a, f.quot * b + f.rem);
+      EXPECT_TRUE(f.rem == 0 || (f.rem < 0) == (b < 0));
+      EXPECT_TRUE((f.rem < 0 ? -f.rem : f.rem) < (b < 0 ? -b : b));
+    }
+  }
+  EXPECT_EQ(-3, divmod_floor(-7, 3).quot);
+  EXPECT_EQ(2, divmod_floor(-7, 3).rem);
+  EXPECT_EQ(-3, divmod_floor(7, -3).quot);
+  EXPECT_EQ(-2, divmod_floor(7, -3).rem);
+  EXPECT_EQ(-2, divmod(-7, 3).quot);
+  EXPECT_EQ(-1, divmod(-7, 3).rem);
+}
+
+TEST(correctness, divmod_aliasing) {
+  big_integer a("-123456789012345678901234567890123456789");
+  big_integer b("98765432109876543210");
+  big_integer_divmod expected = divmod_floor(a, b);
+
+  big_integer q = a;
+  big_integer r = b;
+  divmod_floor(q, r, q, r);
+  EXPECT_EQ(expected.quot, q);
+  EXPECT_EQ(expected.rem, r);
+
+  q = a;
+  r = b;
+  divmod(q, r, r, q);
+  EXPECT_EQ(a / b, r);
+  EXPECT_EQ(a % b, q);
+
+  q = a;
+  divmod(q, q, q, r);
+  EXPECT_EQ(1, q);
+  EXPECT_EQ(0, r);
+}
+
+TEST(correctness, divmod_errors) {
+  big_integer a = big_integer(1) << 10000;
+  big_integer q = 5, r = 7;
+  EXPECT_THROW(divmod(a, big_integer()), std::invalid_argument);
+  EXPECT_THROW(divmod_floor(-a, 0), std::invalid_argument);
+  EXPECT_THROW(divmod(a, 0, q, r), std::invalid_argument);
+  EXPECT_EQ(5, q);
+  EXPECT_EQ(7, r);
+  EXPECT_THROW(divmod(a, 3, q, q), std::invalid_argument);
+  EXPECT_THROW(divmod_floor(a, 3, r, r), std::invalid_argument);
+  EXPECT_EQ(7, r);
+}
+
+TEST(correctness, div_by_zero) {
+  big_integer zero;
+  for (big_integer a : {big_integer(), big_integer(-5),
+                        big_integer(1) << 10000}) {
+    big_integer copy = a;
+    EXPECT_THROW(a / zero, std::invalid_argument);
+    EXPECT_THROW(a % zero, std::invalid_argument);
+    EXPECT_THROW(a / 0, std::invalid_argument);
+    EXPECT_THROW(a % 0u, std::invalid_argument);
+    EXPECT_THROW(a /= zero, std::invalid_argument);
+    EXPECT_THROW(a %= 0, std::invalid_argument);
+    EXPECT_EQ(copy, a);
+  }
+}
+
+namespace {
+big_integer naive_powmod(big_integer base, big_integer exp,
+                         big_integer const& mod) {
+  big_integer res = 1;
+  base = divmod_floor(base, mod).rem;
+  for (; exp > 0; exp >>= 1) {
+    if ((exp & 1) != 0) {
+      res = res * base % mod;
+    }
+    base = base * base % mod;
+  }
+  return res % mod;
+}
+} // namespace
+
+TEST(correctness, powmod) {
+  EXPECT_EQ(1, powmod(2, 0, 7));
+  EXPECT_EQ(0, powmod(5, 3, 1));
+  EXPECT_EQ(1, powmod(0, 0, 10));
+  EXPECT_EQ(4, powmod(-2, 3, 12));
+  EXPECT_EQ(8, powmod(-2, 3, 16));
+  EXPECT_EQ(445, powmod(4, 13, 497));
+  EXPECT_THROW(powmod(2, 3, 0), std::invalid_argument);
+  EXPECT_THROW(powmod(2, -1, 7), std::invalid_argument);
+
+  // 2^(p - 1) = 1 по модулю простого 2^127 - 1
+  big_integer p = (big_integer(1) << 127) - 1;
+  EXPECT_EQ(1, powmod(2, p - 1, p));
+  EXPECT_EQ(1, powmod(3, p - 1, p));
+}
+
+TEST(correctness, powmod_random) {
+  std::mt19937 rng(6174);
+  for (auto [n, e] : {std::pair{1, 1}, {2, 3}, {4, 4}, {17, 10}, {64, 64},
+                      {128, 100}}) {
+    big_integer mod = random_unsigned(rng, n) | 1;
+    big_integer base = random_big_integer(rng, n + 1);
+    big_integer exp = random_unsigned(rng, e);
+    EXPECT_EQ(naive_powmod(base, exp, mod), powmod(base, exp, mod));
+    EXPECT_EQ(naive_powmod(-base, exp, mod), powmod(-base, exp, mod));
+    EXPECT_EQ(naive_powmod(base, exp, mod + 1), powmod(base, exp, mod + 1));
+  }
+}
+
+TEST(correctness, modulus_context) {
+  std::mt19937 rng(8128);
+  for (size_t n : {1, 2, 3, 16, 33, 200, 300}) {
+    big_integer mod = random_unsigned(rng, n) + 1;
+    modulus_context ctx(mod);
+    EXPECT_EQ(mod, ctx.modulus());
+    for (size_t len : {size_t(1), n, 2 * n, 2 * n + 1, 5 * n + 3}) {
+      big_integer a = random_big_integer(rng, len);
+      EXPECT_EQ(divmod_floor(a, mod).rem, ctx.reduce(a));
+    }
+    big_integer a = ctx.reduce(random_big_integer(rng, n + 1));
+    big_integer b = ctx.reduce(random_big_integer(rng, n));
+    EXPECT_EQ(a * b % mod, ctx.mulmod(a, b));
+    EXPECT_EQ((a + b) % mod, ctx.addmod(a, b));
+    EXPECT_EQ(divmod_floor(a - b, mod).rem, ctx.submod(a, b));
+    EXPECT_EQ(divmod_floor(b - a, mod).rem, ctx.submod(b, a));
+    EXPECT_EQ(0, ctx.reduce(mod * mod));
+    EXPECT_EQ(mod - 1, ctx.reduce(mod * mod - 1));
+    EXPECT_EQ(0, ctx.reduce(-mod));
+  }
+  // Обратное к нормированной степени двойки не помещается в n разрядов
+  for (int bits : {1, 64, 200, 1000}) {
+    big_integer mod = big_integer(1) << bits;
+    modulus_context ctx(mod);
+    big_integer a = random_big_integer(rng, 2 * bits / 32 + 2);
+    EXPECT_EQ(divmod_floor(a, mod).rem, ctx.reduce(a));
+    EXPECT_EQ(mod - 1, ctx.reduce(mod * mod - 1));
+  }
+  EXPECT_THROW(modulus_context(0), std::invalid_argument);
+}
+
+namespace {
+big_integer naive_gcd(big_integer a, big_integer b) {
+  a = a < 0 ? -a : a;
+  b = b < 0 ? -b : b;
+  while (b != 0) {
+    a %= b;
+    std::swap(a, b);
+  }
+  return a;
+}
+} // namespace
+
+TEST(correctness, gcd) {
+  EXPECT_EQ(0, gcd(0, 0));
+  EXPECT_EQ(5, gcd(0, -5));
+  EXPECT_EQ(5, gcd(-5, 0));
+  EXPECT_EQ(6, gcd(-12, 18));
+  EXPECT_EQ(1, gcd(17, 5));
+
+  // Соседние числа Фибоначчи: все частные равны 1
+  big_integer f0 = 0, f1 = 1;
+  for (size_t i = 0; i < 20000; i++) {
+    f0 += f1;
+    std::swap(f0, f1);
+  }
+  EXPECT_EQ(1, gcd(f1, f0));
+  EXPECT_EQ(f0, gcd(f0, f0));
+  EXPECT_EQ(f0, gcd(f0 * f1, f0));
+}
+
+TEST(correctness, gcd_random) {
+  std::mt19937 rng(1729);
+  for (auto [n, m] : {std::pair{1, 1}, {3, 2}, {4, 4}, {9, 20}, {40, 33},
+                      {100, 100}, {300, 280}, {600, 600}, {700, 90}}) {
+    big_integer g = random_unsigned(rng, rng() % 50 + 1);
+    big_integer a = random_big_integer(rng, n);
+    big_integer b = random_big_integer(rng, m);
+    EXPECT_EQ(naive_gcd(a, b), gcd(a, b));
+    EXPECT_EQ(naive_gcd(a * g, b * g), gcd(a * g, b * g));
+  }
+}
+
+TEST(correctness, gcd_ext) {
+  std::mt19937 rng(3435);
+  for (auto [n, m] : {std::pair{1, 1}, {2, 5}, {8, 8}, {65, 60}, {300, 300},
+                      {600, 590}}) {
+    big_integer g = random_unsigned(rng, n / 4 + 1);
+    big_integer a = random_big_integer(rng, n) * g;
+    big_integer b = random_big_integer(rng, m) * g;
+    big_integer x, y;
+    big_integer d = gcd_ext(a, b, x, y);
+    EXPECT_EQ(gcd(a, b), d);
+    EXPECT_EQ(d, a * x + b * y);
+  }
+  big_integer a = 240, b = -46, x, y;
+  EXPECT_EQ(2, gcd_ext(a, b, x, y));
+  EXPECT_EQ(2, 240 * x - 46 * y);
+  EXPECT_EQ(7, gcd_ext(0, -7, x, y));
+  EXPECT_EQ(7, -7 * y);
+  EXPECT_EQ(0, gcd_ext(0, 0, x, y));
+
+  x = 35;
+  y = 21;
+  big_integer d = gcd_ext(x, y, x, y);
+  EXPECT_EQ(7, d);
+  EXPECT_EQ(7, 35 * x + 21 * y);
+}
+
+TEST(correctness, gcd_ext_long) {
+  // Длины выше порогов половинного НОД: d делит a и b и равен a x + b y,
+  // значит, d -- НОД
+  std::mt19937 rng(5040);
+  big_integer f0 = 0, f1 = 1;
+  for (size_t i = 0; i < 100000; i++) {
+    f0 += f1;
+    std::swap(f0, f1);
+  }
+  big_integer g = random_unsigned(rng, 300);
+  std::pair<big_integer, big_integer> cases[] = {
+      {f1, f0},
+      {f1 * g, f0 * g},
+      {random_unsigned(rng, 5000) * g, random_unsigned(rng, 4900) * g},
+      {random_unsigned(rng, 3000), random_unsigned(rng, 2990)},
+      {random_unsigned(rng, 4000) << 5000, random_unsigned(rng, 4000)},
+  };
+  for (auto& [a, b] : cases) {
+    big_integer x, y;
+    big_integer d = gcd_ext(a, b, x, y);
+    EXPECT_EQ(d, a * x + b * y);
+    EXPECT_EQ(0, a % d);
+    EXPECT_EQ(0, b % d);
+    EXPECT_EQ(d, gcd(a, b));
+  }
+}
+
+TEST(correctness, modinv) {
+  EXPECT_EQ(4, modinv(3, 11));
+  EXPECT_EQ(7, modinv(-3, 11));
+  EXPECT_EQ(0, modinv(5, 1));
+  EXPECT_THROW(modinv(6, 9), std::invalid_argument);
+  EXPECT_THROW(modinv(3, 0), std::invalid_argument);
+  EXPECT_THROW(modinv(3, -11), std::invalid_argument);
+
+  std::mt19937 rng(2187);
+  for (size_t n : {1, 2, 7, 64, 300, 500}) {
+    big_integer m = random_unsigned(rng, n) | 1;
+    big_integer a = random_big_integer(rng, n + 1);
+    if (gcd(a, m) != 1) {
+      continue;
+    }
+    big_integer inv = modinv(a, m);
+    EXPECT_TRUE(inv >= 0 && inv < m);
+    EXPECT_EQ(1, divmod_floor(a * inv, m).rem);
+  }
+  // Обратный по модулю 2^k
+  big_integer m = big_integer(1) << 4000;
+  big_integer a = (big_integer(3) << 3000) + 1;
+  EXPECT_EQ(1, a * modinv(a, m) % m);
+}
+
+TEST(correctness, isqrt) {
+  for (int i = 0; i < 2000; i++) {
+    big_integer r = isqrt(i);
+    EXPECT_TRUE(r * r <= i && (r + 1) * (r + 1) > i);
+  }
+  EXPECT_THROW(isqrt(-1), std::invalid_argument);
+
+  std::mt19937 rng(4096);
+  for (size_t n : {1, 2, 3, 5, 16, 100, 1000, 3000}) {
+    big_integer x = random_unsigned(rng, n);
+    big_integer sq = x * x;
+    EXPECT_EQ(x, isqrt(sq));
+    EXPECT_EQ(x, isqrt(sq + 2 * x));
+    EXPECT_EQ(x - 1, isqrt(sq - 1));
+    big_integer a = random_unsigned(rng, n);
+    big_integer r = isqrt(a);
+    EXPECT_TRUE(r * r <= a && (r + 1) * (r + 1) > a);
+  }
+}
+
+TEST(correctness, iroot) {
+  EXPECT_EQ(0, iroot(0, 5));
+  EXPECT_EQ(1, iroot(1, 100));
+  EXPECT_EQ(1, iroot(big_integer(1) << 99, 100));
+  EXPECT_EQ(2, iroot(big_integer(1) << 100, 100));
+  EXPECT_EQ(-3, iroot(-27, 3));
+  EXPECT_EQ(-3, iroot(-63, 3));
+  EXPECT_EQ(12345, iroot(12345, 1));
+  EXPECT_THROW(iroot(8, 0), std::invalid_argument);
+  EXPECT_THROW(iroot(-16, 4), std::invalid_argument);
+
+  std::mt19937 rng(6561);
+  for (uint32_t k : {2, 3, 5, 7, 31, 64, 257}) {
+    for (size_t n : {1, 2, 9, 60}) {
+      big_integer x = random_unsigned(rng, n);
+      big_integer p = 1;
+      for (uint32_t i = 0; i < k; i++) {
+        p *= x;
+      }
+      EXPECT_EQ(x, iroot(p, k));
+      EXPECT_EQ(x - 1, iroot(p - 1, k));
+      EXPECT_EQ(x, iroot(p + 1, k));
+    }
+  }
+  for (uint32_t k : {2, 3, 4, 11}) {
+    for (size_t n : {3, 17, 200}) {
+      big_integer a = random_unsigned(rng, n);
+      big_integer r = iroot(a, k);
+      big_integer lo = 1, hi = 1;
+      for (uint32_t i = 0; i < k; i++) {
+        lo *= r;
+        hi *= r + 1;
+      }
+      EXPECT_TRUE(lo <= a && a < hi);
+    }
+  }
+}
+
 TEST(correctness, negation_long) {
   big_integer a("10000000000000000000000000000000000000000000000000000");
   big_integer c("-10000000000000000000000000000000000000000000000000000");
@@ -586,6 +1341,41 @@ TEST(correctness, negation_long) {
   EXPECT_EQ(a, -c);
 }
 
+TEST(correctness, bitwise_long) {
+  std::mt19937 rng(2025);
+  // Длины с хвостами, не кратными векторам, и числа разной длины, чтобы
+  // короткий операнд расширялся знаком
+  for (size_t i = 0; i < 200; i++) {
+    big_integer a = random_big_integer(rng, 1 + rng() % 70);
+    big_integer b = random_big_integer(rng, 1 + rng() % 70);
+    big_integer conj = a & b;
+    big_integer disj = a | b;
+    EXPECT_EQ(a + b, conj + disj);
+    EXPECT_EQ(disj - conj, a ^ b);
+    EXPECT_EQ(a - conj, and_not(a, b));
+    EXPECT_EQ(-a - 1, ~a);
+    EXPECT_EQ(a & ~b, and_not(a, b));
+    EXPECT_EQ(conj, and_not(a, ~b));
+  }
+  big_integer a = random_big_integer(rng, 1 << 15);
+  big_integer b = a;
+  b ^= a;
+  EXPECT_EQ(0, b);
+  b = a;
+  b &= b;
+  EXPECT_EQ(a, b);
+  b |= b;
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(0, and_not(a, a));
+  EXPECT_EQ(-1, a | ~a);
+  EXPECT_EQ(a, ~~a);
+  big_integer ones = (big_integer(1) << (1 << 20)) - 1;
+  big_integer p = a < 0 ? -a : a;
+  EXPECT_EQ(p, p & ones);
+  EXPECT_EQ(ones - p, p ^ ones);
+  EXPECT_EQ(-1, (-ones) | ones);
+}
+
 TEST(correctness, shl_long) {
   EXPECT_EQ(
       big_integer("1091951238831590836520041079875950759639875963123939936"),
@@ -644,6 +1434,460 @@ TEST(correctness, string_conv) {
   EXPECT_EQ("-2147483649", to_string(lim));
 }
 
+TEST(correctness, string_conv_long) {
+  for (size_t digits : {100, 288, 289, 1000, 5000, 20000}) {
+    std::string nines(digits, '9');
+    std::string power = "1" + std::string(digits, '0');
+    std::string sparse = "1" + std::string(digits / 2, '0') + "7" +
+                         std::string(digits - digits / 2, '0') + "3";
+    for (std::string const& s : {nines, power, sparse}) {
+      EXPECT_EQ(s, to_string(big_integer(s)));
+      EXPECT_EQ("-" + s, to_string(big_integer("-" + s)));
+    }
+  }
+}
+
+TEST(correctness, string_parse_long) {
+  big_integer power = 1000000000;
+  for (size_t digits = 9; digits <= 9000; digits += 9) {
+    if (digits % 900 == 0 || digits == 576 || digits == 585) {
+      std::string zeros(digits, '0');
+      EXPECT_EQ(power, big_integer("1" + zeros));
+      EXPECT_EQ(-power, big_integer("-1" + zeros));
+      EXPECT_EQ(power - 1, big_integer(std::string(digits, '9')));
+      EXPECT_EQ(power, big_integer(zeros + "1" + zeros));
+    }
+    power *= 1000000000;
+  }
+}
+
+TEST(correctness, string_conv_powers) {
+  // Длины записи на границах степеней b^(d * 2^k), по которым делится
+  // число, и буфер to_chars ровно по длине записи
+  for (size_t len : {1, 9, 18, 19, 20, 38, 152, 153, 1216, 2431, 4864,
+                     9728, 9729}) {
+    for (uint32_t base : {10, 7, 36}) {
+      big_integer p = 1;
+      for (size_t i = 0; i < len; i++) {
+        p *= base;
+      }
+      std::string nines(len, "0123456789abcdefghijklmnopqrstuvwxyz"[base - 1]);
+      EXPECT_EQ(nines, to_string(p - 1, base));
+      EXPECT_EQ("-1" + std::string(len, '0'), to_string(-p, base));
+      std::string buf(len + 1, '?');
+      std::to_chars_result res =
+          to_chars(&buf[0], &buf[0] + len + 1, -p + 1, base);
+      EXPECT_EQ(std::errc(), res.ec);
+      EXPECT_EQ("-" + nines, buf);
+      EXPECT_EQ(std::errc::value_too_large,
+                to_chars(&buf[0], &buf[0] + len, -p + 1, base).ec);
+    }
+  }
+}
+
+TEST(correctness, string_conv_random) {
+  std::mt19937 rng(99);
+  for (size_t n : {30, 33, 64, 100, 1000, 3000}) {
+    big_integer a = random_big_integer(rng, n);
+    EXPECT_EQ(a, big_integer(to_string(a)));
+  }
+}
+
+TEST(correctness, string_conv_base) {
+  EXPECT_EQ("ff", to_string(big_integer(255), 16));
+  EXPECT_EQ("-ff", to_string(big_integer(-255), 16));
+  EXPECT_EQ("-100000000", to_string(big_integer(-256), 2));
+  EXPECT_EQ("-777", to_string(big_integer(-511), 8));
+  EXPECT_EQ("z", to_string(big_integer(35), 36));
+  EXPECT_EQ("0", to_string(big_integer(0), 32));
+  EXPECT_EQ(255, big_integer("FF", 16));
+  EXPECT_EQ(-255, big_integer("-00fF", 16));
+  EXPECT_EQ(46655, big_integer("zzz", 36));
+  EXPECT_EQ(-5, big_integer("-101", 2));
+
+  EXPECT_THROW(big_integer("12", 2), std::invalid_argument);
+  EXPECT_THROW(big_integer("g", 16), std::invalid_argument);
+  EXPECT_THROW(big_integer("-", 16), std::invalid_argument);
+  EXPECT_THROW(big_integer("1", 1), std::invalid_argument);
+  EXPECT_THROW(big_integer("1", 37), std::invalid_argument);
+  EXPECT_THROW(to_string(big_integer(1), 0), std::invalid_argument);
+
+  // -2^k записывается в дополнительном коде одним старшим битом
+  for (size_t k : {31, 32, 63, 64, 65, 127, 128, 1000}) {
+    big_integer p = big_integer(1) << k;
+    std::string bits = "1" + std::string(k, '0');
+    EXPECT_EQ(bits, to_string(p, 2));
+    EXPECT_EQ("-" + bits, to_string(-p, 2));
+    EXPECT_EQ(-p, big_integer("-" + bits, 2));
+    EXPECT_EQ(p - 1, big_integer(std::string(k, '1'), 2));
+    EXPECT_EQ("-" + std::string(k, '1'), to_string(1 - p, 2));
+  }
+}
+
+TEST(correctness, string_conv_base_random) {
+  std::mt19937 rng(36);
+  for (size_t n : {1, 2, 3, 30, 300, 3000}) {
+    big_integer a = random_big_integer(rng, n);
+    for (uint32_t base = 2; base <= 36; base++) {
+      std::string s = to_string(a, base);
+      EXPECT_EQ(a, big_integer(s, base));
+      EXPECT_EQ(s, to_string(big_integer(s, base), base));
+    }
+    EXPECT_EQ(to_string(a), to_string(a, 10));
+
+    // Запись по основанию 32 сверяется со схемой Горнера
+    std::string s = to_string(a, 32);
+    big_integer horner = 0;
+    for (char c : s) {
+      if (c != '-') {
+        horner = horner * 32 + (c <= '9' ? c - '0' : c - 'a' + 10);
+      }
+    }
+    EXPECT_EQ(a, s[0] == '-' ? -horner : horner);
+  }
+}
+
+TEST(correctness, to_chars) {
+  char buf[64];
+  big_integer a("-123456789012345678901234567890");
+  std::to_chars_result res = to_chars(buf, buf + 31, a);
+  EXPECT_EQ(std::errc(), res.ec);
+  EXPECT_EQ("-123456789012345678901234567890", std::string(buf, res.ptr));
+  EXPECT_EQ(std::errc::value_too_large, to_chars(buf, buf + 30, a).ec);
+  EXPECT_EQ(std::errc::value_too_large, to_chars(buf, buf, 0).ec);
+  res = to_chars(buf, buf + 3, 255, 16);
+  EXPECT_EQ("ff", std::string(buf, res.ptr));
+  res = to_chars(buf, buf + 1, 0, 2);
+  EXPECT_EQ("0", std::string(buf, res.ptr));
+
+  std::mt19937 rng(2718);
+  for (size_t n : {1, 2, 5, 40, 300}) {
+    big_integer x = random_big_integer(rng, n);
+    big_integer p = big_integer(1) << (32 * n);
+    for (big_integer y : {x, -x, p, -p, p - 1, 1 - p}) {
+      for (uint32_t base : {2, 3, 8, 10, 16, 32, 36}) {
+        std::string str = to_string(y, base);
+        size_t size = to_chars_size(y, base);
+        EXPECT_LE(str.size(), size);
+        if ((base & (base - 1)) == 0) {
+          EXPECT_EQ(str.size(), size);
+        }
+        std::string out(str.size(), '?');
+        res = to_chars(&out[0], &out[0] + out.size(), y, base);
+        EXPECT_EQ(std::errc(), res.ec);
+        EXPECT_EQ(str, out);
+        EXPECT_EQ(std::errc::value_too_large,
+                  to_chars(&out[0], &out[0] + out.size() - 1, y, base).ec);
+      }
+    }
+  }
+}
+
+TEST(correctness, from_chars) {
+  std::string str = "-12345678901234567890123x";
+  big_integer a = 7;
+  std::from_chars_result res =
+      from_chars(str.data(), str.data() + str.size(), a);
+  EXPECT_EQ(std::errc(), res.ec);
+  EXPECT_EQ(str.data() + str.size() - 1, res.ptr);
+  EXPECT_EQ(big_integer("-12345678901234567890123"), a);
+
+  str = "fFg";
+  res = from_chars(str.data(), str.data() + str.size(), a, 16);
+  EXPECT_EQ(str.data() + 2, res.ptr);
+  EXPECT_EQ(255, a);
+
+  for (std::string bad : {"", "-", "+5", "-x", " 1"}) {
+    res = from_chars(bad.data(), bad.data() + bad.size(), a);
+    EXPECT_EQ(std::errc::invalid_argument, res.ec);
+    EXPECT_EQ(bad.data(), res.ptr);
+    EXPECT_EQ(255, a);
+  }
+}
+
+TEST(correctness, stream_io) {
+  std::istringstream in("  42 -17\n-0 ff -z");
+  big_integer a, b, c, d;
+  in >> a >> b >> c >> std::hex >> d;
+  EXPECT_EQ(42, a);
+  EXPECT_EQ(-17, b);
+  EXPECT_EQ(0, c);
+  EXPECT_EQ(255, d);
+  EXPECT_TRUE(in.good());
+  in >> a;
+  EXPECT_TRUE(in.fail());
+  EXPECT_EQ(42, a);
+
+  std::istringstream tail("123");
+  tail >> a;
+  EXPECT_FALSE(tail.fail());
+  EXPECT_TRUE(tail.eof());
+  EXPECT_EQ(123, a);
+
+  std::ostringstream out;
+  out << big_integer(-255) << ' ' << std::hex << big_integer(-255) << ' '
+      << std::oct << big_integer(8);
+  EXPECT_EQ("-255 -ff 10", out.str());
+}
+
+TEST(correctness, stream_output_base) {
+  // Вывод учитывает std::hex и std::oct так же, как для встроенных целых.
+  // Флаг основания остаётся на потоке до std::dec, showbase и uppercase
+  // не поддерживаются, ширина поля работает как для строки
+  big_integer a = (big_integer(1) << 100) + 255;
+  std::ostringstream out;
+  out << std::hex << a << ' ' << -a << ' ' << big_integer(0);
+  EXPECT_EQ("100000000000000000000000ff -100000000000000000000000ff 0",
+            out.str());
+
+  out.str("");
+  out << std::oct << big_integer(-8) << ' ' << std::dec << a;
+  EXPECT_EQ("-10 1267650600228229401496703205631", out.str());
+
+  out.str("");
+  out << std::hex << std::showbase << std::uppercase << big_integer(255);
+  EXPECT_EQ("ff", out.str());
+
+  out.str("");
+  out << std::dec << std::setw(6) << big_integer(-42) << '|' << std::left
+      << std::setw(4) << big_integer(7) << '|';
+  EXPECT_EQ("   -42|7   |", out.str());
+}
+
+TEST(correctness, stream_input_long) {
+  // Длины вокруг границ кусков по 64 разряда цифр для обеих разрядностей
+  std::mt19937 rng(31415);
+  for (uint32_t base : {10, 16}) {
+    for (size_t len : {1, 575, 576, 577, 1215, 1216, 1217, 2432, 3648, 5000,
+                       8517, 20000}) {
+      std::string digits;
+      for (size_t i = 0; i < len; i++) {
+        digits.push_back("0123456789abcdef"[rng() % base]);
+      }
+      digits[0] = '1';
+      big_integer expected(digits, base);
+      std::istringstream in("-" + digits + " " + digits);
+      if (base == 16) {
+        in >> std::hex;
+      }
+      big_integer a, b, c;
+      in >> a >> b;
+      EXPECT_EQ(-expected, a);
+      EXPECT_EQ(expected, b);
+      from_chars(digits.data(), digits.data() + len, c, base);
+      EXPECT_EQ(expected, c);
+    }
+  }
+}
+
+TEST(correctness, limbs_view) {
+  using limb = big_integer::limb;
+  big_integer a = -1;
+  ASSERT_EQ(1u, a.limbs().size());
+  EXPECT_EQ(std::numeric_limits<limb>::max(), a.limbs()[0]);
+
+  int bits = std::numeric_limits<limb>::digits;
+  big_integer b = (big_integer(5) << (3 * bits)) + 7;
+  std::vector<limb> v(b.limbs().begin(), b.limbs().end());
+  ASSERT_EQ(4u, v.size());
+  EXPECT_EQ(std::vector<limb>({7, 0, 0, 5}), v);
+  EXPECT_EQ(b.limbs().data(), b.limbs().begin());
+}
+
+namespace {
+std::vector<unsigned char> encode(big_integer const& a) {
+  std::vector<unsigned char> res(a.encoded_size());
+  EXPECT_EQ(res.size(), a.encode(res.data()));
+  return res;
+}
+} // namespace
+
+TEST(correctness, binary_encoding) {
+  EXPECT_EQ(std::vector<unsigned char>({0, 0, 0, 0, 0, 0, 0, 0, 0}),
+            encode(0));
+  EXPECT_EQ(std::vector<unsigned char>({0, 0, 0, 0, 0, 0, 0, 0, 1}),
+            encode(-1));
+  EXPECT_EQ(std::vector<unsigned char>({1, 0, 0, 0, 0, 0, 0, 0, 0, 0x80}),
+            encode(128));
+  EXPECT_EQ(std::vector<unsigned char>({1, 0, 0, 0, 0, 0, 0, 0, 1, 0x7f}),
+            encode(-129));
+  EXPECT_EQ(std::vector<unsigned char>({1, 0, 0, 0, 0, 0, 0, 0, 1, 0}),
+            encode(-256));
+  EXPECT_EQ(std::vector<unsigned char>({2, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0x7f}),
+            encode(-32768 - 256));
+
+  std::mt19937 rng(1337);
+  for (size_t n : {1, 2, 3, 17, 1000}) {
+    for (big_integer a : {random_big_integer(rng, n),
+                          big_integer(1) << (32 * n - 1),
+                          -(big_integer(1) << (32 * n))}) {
+      std::vector<unsigned char> bytes = encode(a);
+      big_integer b = 42;
+      EXPECT_EQ(bytes.size(), b.decode(bytes.data(), bytes.size()));
+      EXPECT_EQ(a, b);
+    }
+  }
+}
+
+TEST(correctness, binary_decoding) {
+  // Записи идут подряд, лишние старшие байты знака допустимы
+  std::vector<unsigned char> bytes = {2, 0, 0, 0, 0, 0, 0, 0, 0, 5, 0,
+                                      3, 0, 0, 0, 0, 0, 0, 0, 1, 0xfe, 0xff,
+                                      0xff};
+  big_integer a = big_integer(-1) << 10000;
+  big_integer b;
+  size_t used = a.decode(bytes.data(), bytes.size());
+  EXPECT_EQ(11u, used);
+  EXPECT_EQ(5, a);
+  EXPECT_EQ(12u, b.decode(bytes.data() + used, bytes.size() - used));
+  EXPECT_EQ(-2, b);
+
+  EXPECT_THROW(a.decode(bytes.data(), 8), std::invalid_argument);
+  EXPECT_THROW(a.decode(bytes.data(), 10), std::invalid_argument);
+  bytes[8] = 2;
+  EXPECT_THROW(a.decode(bytes.data(), bytes.size()), std::invalid_argument);
+  EXPECT_EQ(5, a);
+}
+
+TEST(correctness, hash) {
+  std::hash<big_integer> h;
+  EXPECT_EQ(h(0), h(-big_integer(0)));
+  EXPECT_EQ(h(big_integer("-123456789012345678901234567890")),
+            h(-big_integer("123456789012345678901234567890")));
+  // Разность длинных чисел короче их самих
+  big_integer a = (big_integer(1) << 1000) + 5;
+  big_integer b = (big_integer(1) << 1000) - 7;
+  EXPECT_EQ(h(12), h(a - b));
+  EXPECT_EQ(h(-1), h(b - a + 11));
+  EXPECT_EQ(h(big_integer(1) << 64), h((big_integer(1) << 65) >> 1));
+
+  // Различные числа, 0 << 64 == 0 встречается дважды
+  std::unordered_set<size_t> hashes;
+  for (int i = -500; i < 500; i++) {
+    hashes.insert(h(i));
+    hashes.insert(h(big_integer(i) << 64));
+  }
+  EXPECT_EQ(1999u, hashes.size());
+}
+
+TEST(correctness, hash_map) {
+  std::mt19937 rng(4242);
+  std::unordered_map<big_integer, size_t> map;
+  std::unordered_map<hashed_big_integer, size_t> hashed;
+  std::vector<big_integer> keys;
+  for (size_t i = 0; i < 300; i++) {
+    keys.push_back(random_big_integer(rng, 1 + i % 40));
+    map[keys.back()] = i;
+    hashed[hashed_big_integer(keys.back())] = i;
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    big_integer key = big_integer(to_string(keys[i]));
+    EXPECT_EQ(i, map.at(key));
+    hashed_big_integer hk(key);
+    EXPECT_EQ(std::hash<big_integer>()(key), hk.hash());
+    EXPECT_EQ(key, hk.value());
+    EXPECT_EQ(i, hashed.at(hk));
+  }
+  EXPECT_EQ(0u, map.count(keys[0] + 1));
+  EXPECT_TRUE(hashed_big_integer(keys[0]) != hashed_big_integer(keys[0] + 1));
+}
+
+TEST(correctness, batch_conversion) {
+  size_t bits = 8 * sizeof(big_integer::limb);
+  big_integer_batch batch(5, 2);
+  EXPECT_EQ(5u, batch.lanes());
+  EXPECT_EQ(2u, batch.width());
+  EXPECT_EQ(0, batch.get(3));
+  big_integer min = -(big_integer(1) << (2 * bits - 1));
+  big_integer values[] = {min, min - min - 1, -1, 12345,
+                          (big_integer(1) << (2 * bits - 1)) - 1};
+  for (size_t i = 0; i < 5; i++) {
+    batch.set(i, values[i]);
+  }
+  for (size_t i = 0; i < 5; i++) {
+    EXPECT_EQ(values[i], batch.get(i));
+  }
+  EXPECT_EQ(big_integer::limb(-1), batch.column(1)[2]);
+  EXPECT_EQ(big_integer::limb(12345), batch.column(0)[3]);
+  EXPECT_THROW(batch.set(0, min - 1), std::invalid_argument);
+  EXPECT_THROW(batch.set(0, big_integer(1) << (2 * bits - 1)),
+               std::invalid_argument);
+  EXPECT_EQ(min, batch.get(0));
+  EXPECT_THROW(big_integer_batch(3, 0), std::invalid_argument);
+}
+
+namespace {
+// x по модулю 2^bits в [-2^(bits - 1), 2^(bits - 1))
+big_integer wrap(big_integer const& x, size_t bits) {
+  big_integer r = x & ((big_integer(1) << bits) - 1);
+  return r < (big_integer(1) << (bits - 1)) ? r : r - (big_integer(1) << bits);
+}
+} // namespace
+
+TEST(correctness, batch_arithmetic) {
+  std::mt19937 rng(2024);
+  size_t bits = 8 * sizeof(big_integer::limb);
+  size_t lanes = 37;
+  // Ширина 48 -- умножение по одному числу за порогом
+  for (size_t wa : {1, 2, 4, 48}) {
+    for (size_t wb : {1, 3, 4, 48}) {
+      big_integer_batch a(lanes, wa), b(lanes, wb);
+      std::vector<big_integer> x, y;
+      for (size_t i = 0; i < lanes; i++) {
+        // Крайние значения и совпадающие числа вперемешку со случайными
+        x.push_back(wrap(random_big_integer(rng, 2 * wa), wa * bits));
+        y.push_back(i % 5 == 0 ? wrap(x[i], wb * bits)
+                               : wrap(random_big_integer(rng, 2 * wb),
+                                      wb * bits));
+        if (i % 7 == 1) {
+          x[i] = -(big_integer(1) << (wa * bits - 1));
+        }
+        a.set(i, x[i]);
+        b.set(i, y[i]);
+      }
+      for (size_t wr : {size_t(1), std::max(wa, wb) + 1, wa + wb,
+                        wa + wb + 2}) {
+        big_integer_batch sum(lanes, wr), diff(lanes, wr), prod(lanes, wr);
+        add(sum, a, b);
+        sub(diff, a, b);
+        mul(prod, a, b);
+        for (size_t i = 0; i < lanes; i++) {
+          EXPECT_EQ(wrap(x[i] + y[i], wr * bits), sum.get(i));
+          EXPECT_EQ(wrap(x[i] - y[i], wr * bits), diff.get(i));
+          EXPECT_EQ(wrap(x[i] * y[i], wr * bits), prod.get(i));
+        }
+      }
+      std::vector<int32_t> cmp(lanes);
+      compare(a, b, cmp.data());
+      for (size_t i = 0; i < lanes; i++) {
+        EXPECT_EQ(x[i] < y[i] ? -1 : x[i] > y[i] ? 1 : 0, cmp[i]);
+      }
+    }
+  }
+}
+
+TEST(correctness, batch_aliasing) {
+  std::mt19937 rng(7);
+  size_t bits = 8 * sizeof(big_integer::limb);
+  big_integer_batch a(10, 4), b(10, 4);
+  std::vector<big_integer> x;
+  for (size_t i = 0; i < 10; i++) {
+    x.push_back(wrap(random_big_integer(rng, 6), 4 * bits));
+    a.set(i, x[i]);
+  }
+  add(b, a, a);
+  mul(a, a, b);
+  sub(b, b, a);
+  for (size_t i = 0; i < 10; i++) {
+    big_integer square = wrap(2 * x[i] * x[i], 4 * bits);
+    EXPECT_EQ(square, a.get(i));
+    EXPECT_EQ(wrap(2 * x[i] - square, 4 * bits), b.get(i));
+  }
+  big_integer_batch c(11, 4);
+  EXPECT_THROW(add(c, a, b), std::invalid_argument);
+  EXPECT_THROW(mul(a, c, b), std::invalid_argument);
+}
+
 namespace {
 template <typename T>
 void test_converting_ctor(T value) {
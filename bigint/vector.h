@@ -1,6 +1,7 @@
 #pragma once
 #include <algorithm>
 #include <cstddef>
+#include <utility>
 
 template <typename T>
 struct vector {
@@ -17,6 +18,14 @@ struct vector {
     size_ = capacity_;
   }
 
+  // O(1) nothrow
+  vector(vector<T>&& other) noexcept
+      : data_(other.data_), size_(other.size_), capacity_(other.capacity_) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.capacity_ = 0;
+  }
+
   // O(N) strong
   vector<T>& operator=(vector<T> const& other) {
     if(&other == this) {
@@ -26,6 +35,14 @@ struct vector {
     return *this;
   }
 
+  // O(N) nothrow
+  vector<T>& operator=(vector<T>&& other) noexcept {
+    if (&other != this) {
+      vector(std::move(other)).swap(*this);
+    }
+    return *this;
+  }
+
   bool operator==(vector<T> const& other) const {
     if(other.size_ == size_) {
       for(size_t i = 0; i < size_; i++) {
@@ -134,6 +151,17 @@ struct vector {
     capacity_ = n;
   }
 
+  // O(N) strong
+  void resize(size_t n, T const& value) {
+    reserve(n);
+    while (size_ < n) {
+      push_back(value);
+    }
+    while (size_ > n) {
+      pop_back();
+    }
+  }
+
   // O(N) strong
   void shrink_to_fit() {
     if (size_ < capacity_) {